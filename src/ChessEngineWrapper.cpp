@@ -4,6 +4,8 @@
 #include <string>
 #include <cstring>
 #include <sstream>
+#include <thread>
+#include <atomic>
 
 // Platform-specific export macros
 #ifdef _WIN32
@@ -24,6 +26,12 @@ private:
     chess::Movelist moves_cache;
     bool moves_cache_valid = false;
 
+    // Background search started by startSearch
+    std::thread search_thread;
+    std::atomic<bool> searching{false};
+    chess::Board search_board; // copy of the board the engine thread searches
+    chess::Move async_best_move = chess::Move::NULL_MOVE;
+
     // Helper function to update legal moves cache
     void updateMovesCache()
     {
@@ -64,6 +72,26 @@ private:
 public:
     ChessEngineWrapper() : engine(), evaluator() {}
 
+    // Share the opening book of another engine instead of loading it again
+    explicit ChessEngineWrapper(std::shared_ptr<const OpeningMove> book) : engine(std::move(book)), evaluator() {}
+
+    ~ChessEngineWrapper()
+    {
+        abortSearch();
+    }
+
+    static std::string pvToString(const std::vector<chess::Move> &pv)
+    {
+        std::string result;
+        for (const auto &move : pv)
+        {
+            if (!result.empty())
+                result += ' ';
+            result += chess::uci::moveToUci(move);
+        }
+        return result;
+    }
+
     // Set position from FEN string
     void setPosition(const std::string &fen)
     {
@@ -82,7 +110,11 @@ public:
             return "";
         }
 
+        abortSearch();
+        engine.clearStop();
+        searching = true;
         chess::Move move = engine.getBestMove(board);
+        searching = false;
 
         // Convert the move to a string
         std::stringstream ss;
@@ -90,6 +122,134 @@ public:
         return ss.str();
     }
 
+    // Get the best move in UCI format within the given search limits
+    std::string getBestMoveWithLimits(const SearchLimits &limits)
+    {
+        updateMovesCache();
+
+        if (moves_cache.empty())
+        {
+            return "";
+        }
+
+        abortSearch();
+        engine.clearStop();
+        searching = true;
+        // Nothing could stop an unbounded search while the caller waits for it,
+        // use the default move time and depth of getBestMove instead
+        chess::Move move = limits.bounded(board.sideToMove()) ? engine.getBestMove(board, limits)
+                                                              : engine.getBestMove(board);
+        searching = false;
+
+        std::stringstream ss;
+        ss << move;
+        return ss.str();
+    }
+
+    // Get the principal variation of the last search as space separated UCI moves
+    std::string getPv()
+    {
+        return pvToString(engine.getLastPv());
+    }
+
+    // Start searching the current position on the engine thread and return at once.
+    // Returns false when there is no legal move to search.
+    bool startSearch(const SearchLimits &limits)
+    {
+        abortSearch();
+        updateMovesCache();
+        if (moves_cache.empty())
+        {
+            return false;
+        }
+
+        search_board = board;
+        async_best_move = chess::Move::NULL_MOVE;
+        engine.clearStop();
+        searching = true;
+        search_thread = std::thread([this, limits]()
+                                    {
+                                        async_best_move = engine.getBestMove(search_board, limits);
+                                        searching = false; });
+        return true;
+    }
+
+    // Progress of the running search, returns whether it is still running
+    bool pollSearchInfo(ChessEngine::SearchStats &info)
+    {
+        info = engine.getSearchInfo();
+        return searching;
+    }
+
+    // Stop a running search, it returns its best move so far
+    void stopSearch()
+    {
+        if (searching)
+        {
+            engine.stop();
+        }
+    }
+
+    // Wait for the background search to finish and return its move in UCI format
+    std::string waitBestMove()
+    {
+        finishSearch();
+        if (async_best_move == chess::Move::NULL_MOVE)
+        {
+            return "";
+        }
+        std::stringstream ss;
+        ss << async_best_move;
+        return ss.str();
+    }
+
+    // Join the engine thread, the engine must not be used by two threads at once
+    void finishSearch()
+    {
+        if (search_thread.joinable())
+        {
+            search_thread.join();
+        }
+    }
+
+    // Stop the background search and wait for it, an infinite or ponder search
+    // would otherwise never return
+    void abortSearch()
+    {
+        stopSearch();
+        finishSearch();
+    }
+
+    std::shared_ptr<const OpeningMove> getOpeningBook() const
+    {
+        return engine.getOpeningBook();
+    }
+
+    // Resize the transposition table
+    void setHashSize(int hashMb)
+    {
+        abortSearch();
+        engine.setHashSize(hashMb);
+    }
+
+    // Replace the opening book with a PGN file or a Polyglot .bin book
+    bool loadOpeningBook(const std::string &path, bool random)
+    {
+        abortSearch();
+        engine.setBookSelection(random ? OpeningMove::Selection::WEIGHTED_RANDOM
+                                       : OpeningMove::Selection::BEST_WEIGHT);
+        bool loaded = engine.loadOpeningBook(path);
+        engine.enableOpeningBook(loaded);
+        return loaded;
+    }
+
+    // Set the number of search threads
+    void setThreads(int threads)
+    {
+        abortSearch();
+        engine.setThreads(threads);
+    }
+
     // Get the evaluation of the current position
     int getEvaluation()
     {
@@ -277,155 +437,336 @@ public:
 // Global wrapper instance
 static ChessEngineWrapper *g_wrapper = nullptr;
 
-// C interface for use with Python ctypes
+// Search limits from the flat C arguments, zero leaves a limit unset
+static SearchLimits makeLimits(int wtime, int btime, int winc, int binc,
+                               int movestogo, int movetime, int depth, long long nodes)
+{
+    SearchLimits limits;
+    limits.wtime = wtime;
+    limits.btime = btime;
+    limits.winc = winc;
+    limits.binc = binc;
+    limits.movestogo = movestogo;
+    limits.movetime = movetime;
+    limits.depth = depth;
+    limits.nodes = nodes > 0 ? static_cast<uint64_t>(nodes) : 0;
+    return limits;
+}
+
+// Copy str into a C buffer of max_length bytes, truncating if needed
+static void copyString(const std::string &str, char *result, int max_length)
+{
+    if (result && max_length > 0)
+    {
+        strncpy(result, str.c_str(), max_length - 1);
+        result[max_length - 1] = '\0';
+    }
+}
+
+// C interface for use with Python ctypes.
+//
+// The engine_* functions work on a handle returned by engine_new, so one process
+// can run any number of independent engines. A handle must be used by one thread
+// at a time, except that engine_stop_search and engine_poll_search_info may be
+// called while another thread is searching. The functions without the engine_
+// prefix act on a single global instance made by create_engine.
 extern "C"
 {
-    // Create a chess engine instance
-    EXPORT_API void create_engine()
+    // Create an engine with its own board, hash table and search threads.
+    // hash_mb <= 0 keeps the default size. book_source is an existing handle
+    // whose opening book is shared read-only, or null to load a fresh copy.
+    EXPORT_API ChessEngineWrapper *engine_new(int hash_mb, int threads, ChessEngineWrapper *book_source)
     {
-        if (!g_wrapper)
+        ChessEngineWrapper *handle = book_source ? new ChessEngineWrapper(book_source->getOpeningBook())
+                                                 : new ChessEngineWrapper();
+        if (hash_mb > 0)
         {
-            g_wrapper = new ChessEngineWrapper();
+            handle->setHashSize(hash_mb);
+        }
+        if (threads > 1)
+        {
+            handle->setThreads(threads);
         }
+        return handle;
     }
 
-    // Destroy the chess engine instance
-    EXPORT_API void destroy_engine()
+    // Destroy an engine, a running search is stopped first
+    EXPORT_API void engine_free(ChessEngineWrapper *handle)
     {
-        if (g_wrapper)
+        delete handle;
+    }
+
+    // Resize the transposition table, its contents are lost. A running search is stopped first.
+    EXPORT_API void engine_set_hash_size(ChessEngineWrapper *handle, int hash_mb)
+    {
+        if (handle && hash_mb > 0)
         {
-            delete g_wrapper;
-            g_wrapper = nullptr;
+            handle->setHashSize(hash_mb);
         }
     }
 
-    // Set position from FEN string
-    EXPORT_API void set_position(const char *fen)
+    // Set the number of search threads (Lazy SMP), a running search is stopped first
+    EXPORT_API void engine_set_threads(ChessEngineWrapper *handle, int threads)
     {
-        if (g_wrapper && fen)
+        if (handle)
         {
-            g_wrapper->setPosition(std::string(fen));
+            handle->setThreads(threads);
         }
     }
 
-    // Get the best move as a string
-    EXPORT_API void get_best_move(char *result, int max_length)
+    // Load a PGN or Polyglot .bin opening book. random picks book moves with
+    // probability proportional to their weight instead of the heaviest one.
+    // Returns 0 if the book cannot be read, the engine then plays without one.
+    // A running search is stopped first.
+    EXPORT_API int engine_load_opening_book(ChessEngineWrapper *handle, const char *path, int random)
     {
-        if (g_wrapper && result && max_length > 0)
+        if (!handle || !path)
         {
-            std::string move = g_wrapper->getBestMove();
-            strncpy(result, move.c_str(), max_length - 1);
-            result[max_length - 1] = '\0';
+            return 0;
         }
-        else if (result && max_length > 0)
+        return handle->loadOpeningBook(path, random != 0) ? 1 : 0;
+    }
+
+    // Set position from FEN string
+    EXPORT_API void engine_set_position(ChessEngineWrapper *handle, const char *fen)
+    {
+        if (handle && fen)
         {
-            strncpy(result, "", max_length);
+            handle->setPosition(std::string(fen));
         }
     }
 
-    // Make a move
-    EXPORT_API bool make_move(const char *move)
+    // Get the best move as a string, a search started by engine_start_search is stopped first
+    EXPORT_API void engine_get_best_move(ChessEngineWrapper *handle, char *result, int max_length)
     {
-        return g_wrapper && move && g_wrapper->makeMove(std::string(move));
+        copyString(handle ? handle->getBestMove() : "", result, max_length);
     }
 
-    // Get FEN string of current position
-    EXPORT_API void get_fen(char *result, int max_length)
+    // Get the best move within clock and search limits, zero leaves a limit unset.
+    // Without a clock for the side to move, movetime, depth or nodes, the default
+    // move time and depth of engine_get_best_move apply instead. A search started by
+    // engine_start_search is stopped first.
+    EXPORT_API void engine_get_best_move_with_limits(ChessEngineWrapper *handle, char *result, int max_length,
+                                                     int wtime, int btime, int winc, int binc,
+                                                     int movestogo, int movetime, int depth,
+                                                     long long nodes)
     {
-        if (g_wrapper && result && max_length > 0)
+        std::string move;
+        if (handle && result && max_length > 0)
         {
-            std::string fen = g_wrapper->getFen();
-            strncpy(result, fen.c_str(), max_length - 1);
-            result[max_length - 1] = '\0';
+            move = handle->getBestMoveWithLimits(
+                makeLimits(wtime, btime, winc, binc, movestogo, movetime, depth, nodes));
         }
-        else if (result && max_length > 0)
+        copyString(move, result, max_length);
+    }
+
+    // Start a search on the engine thread and return at once, false if there is nothing to search.
+    // Zero leaves a limit unset, with none set it runs until engine_stop_search. A search
+    // still running from an earlier call is stopped first, its move is discarded.
+    EXPORT_API bool engine_start_search(ChessEngineWrapper *handle, int wtime, int btime, int winc, int binc,
+                                        int movestogo, int movetime, int depth, long long nodes)
+    {
+        return handle &&
+               handle->startSearch(makeLimits(wtime, btime, winc, binc, movestogo, movetime, depth, nodes));
+    }
+
+    // Get the last completed iteration of the running search, returns whether it is still running.
+    // Any of the output pointers may be null.
+    EXPORT_API bool engine_poll_search_info(ChessEngineWrapper *handle, int *depth, int *score,
+                                            long long *nodes, int *time_ms, char *pv, int pv_length)
+    {
+        ChessEngine::SearchStats info;
+        bool running = handle && handle->pollSearchInfo(info);
+        if (depth)
+            *depth = info.depth;
+        if (score)
+            *score = info.score;
+        if (nodes)
+            *nodes = static_cast<long long>(info.nodes);
+        if (time_ms)
+            *time_ms = static_cast<int>(info.duration.count());
+        copyString(ChessEngineWrapper::pvToString(info.pv), pv, pv_length);
+        return running;
+    }
+
+    // Wait for the search started by engine_start_search and get its best move.
+    // A search without limits only ends at engine_stop_search.
+    EXPORT_API void engine_wait_best_move(ChessEngineWrapper *handle, char *result, int max_length)
+    {
+        copyString(handle ? handle->waitBestMove() : "", result, max_length);
+    }
+
+    // Stop a search running on another thread
+    EXPORT_API void engine_stop_search(ChessEngineWrapper *handle)
+    {
+        if (handle)
         {
-            strncpy(result, "", max_length);
+            handle->stopSearch();
         }
     }
 
+    // Get the principal variation of the last search
+    EXPORT_API void engine_get_pv(ChessEngineWrapper *handle, char *result, int max_length)
+    {
+        copyString(handle ? handle->getPv() : "", result, max_length);
+    }
+
+    // Make a move
+    EXPORT_API bool engine_make_move(ChessEngineWrapper *handle, const char *move)
+    {
+        return handle && move && handle->makeMove(std::string(move));
+    }
+
+    // Get FEN string of current position
+    EXPORT_API void engine_get_fen(ChessEngineWrapper *handle, char *result, int max_length)
+    {
+        copyString(handle ? handle->getFen() : "", result, max_length);
+    }
+
     // Check if the game is over
-    EXPORT_API bool is_game_over()
+    EXPORT_API bool engine_is_game_over(ChessEngineWrapper *handle)
     {
-        return g_wrapper && g_wrapper->isGameOver();
+        return handle && handle->isGameOver();
     }
 
     // Reset the board to the starting position
-    EXPORT_API void reset_board()
+    EXPORT_API void engine_reset_board(ChessEngineWrapper *handle)
     {
-        if (g_wrapper)
+        if (handle)
         {
-            g_wrapper->resetBoard();
+            handle->resetBoard();
         }
     }
 
     // Check if a specific move is legal
-    EXPORT_API bool is_move_legal(const char *move)
+    EXPORT_API bool engine_is_move_legal(ChessEngineWrapper *handle, const char *move)
     {
-        return g_wrapper && move && g_wrapper->isMoveLegal(std::string(move));
+        return handle && move && handle->isMoveLegal(std::string(move));
     }
 
     // Check if the current position is in check
-    EXPORT_API bool is_in_check()
+    EXPORT_API bool engine_is_in_check(ChessEngineWrapper *handle)
     {
-        return g_wrapper && g_wrapper->isInCheck();
+        return handle && handle->isInCheck();
     }
 
     // Get the side to move (true for white, false for black)
-    EXPORT_API bool get_side_to_move()
+    EXPORT_API bool engine_get_side_to_move(ChessEngineWrapper *handle)
     {
-        return g_wrapper && g_wrapper->getSideToMove();
+        return handle && handle->getSideToMove();
     }
 
     // Get the evaluation of the current position
-    EXPORT_API int get_evaluation()
+    EXPORT_API int engine_get_evaluation(ChessEngineWrapper *handle)
     {
-        return g_wrapper ? g_wrapper->getEvaluation() : 0;
+        return handle ? handle->getEvaluation() : 0;
     }
 
     // Get the result of the game (0 = ongoing, 1 = white wins, -1 = black wins, 2 = draw)
-    EXPORT_API int get_game_result()
+    EXPORT_API int engine_get_game_result(ChessEngineWrapper *handle)
     {
-        return g_wrapper ? g_wrapper->getGameResult() : 0;
+        return handle ? handle->getGameResult() : 0;
     }
 
     // Get a string description of the game result reason
-    EXPORT_API void get_game_result_reason(char *result, int max_length)
+    EXPORT_API void engine_get_game_result_reason(ChessEngineWrapper *handle, char *result, int max_length)
+    {
+        copyString(handle ? handle->getGameResultReason() : "", result, max_length);
+    }
+
+    // Get all legal moves in the current position, separated by spaces
+    EXPORT_API void engine_get_legal_moves(ChessEngineWrapper *handle, char *result, int max_length)
     {
-        if (g_wrapper && result && max_length > 0)
+        std::stringstream ss;
+        if (handle)
         {
-            std::string reason = g_wrapper->getGameResultReason();
-            strncpy(result, reason.c_str(), max_length - 1);
-            result[max_length - 1] = '\0';
+            std::vector<std::string> moves = handle->getLegalMoves();
+            for (size_t i = 0; i < moves.size(); ++i)
+            {
+                if (i > 0)
+                    ss << " ";
+                ss << moves[i];
+            }
         }
-        else if (result && max_length > 0)
+        copyString(ss.str(), result, max_length);
+    }
+
+    // Single global instance, kept for callers written before the handle API
+
+    // Create the global chess engine instance
+    EXPORT_API void create_engine()
+    {
+        if (!g_wrapper)
         {
-            strncpy(result, "", max_length);
+            g_wrapper = new ChessEngineWrapper();
         }
     }
 
-    // Get all legal moves in the current position
-    EXPORT_API void get_legal_moves(char *result, int max_length)
+    // Destroy the global chess engine instance
+    EXPORT_API void destroy_engine()
     {
-        if (!g_wrapper || !result || max_length <= 0)
+        if (g_wrapper)
         {
-            if (result && max_length > 0)
-                strncpy(result, "", max_length);
-            return;
+            delete g_wrapper;
+            g_wrapper = nullptr;
         }
+    }
 
-        std::vector<std::string> moves = g_wrapper->getLegalMoves();
-        std::stringstream ss;
+    EXPORT_API void set_position(const char *fen) { engine_set_position(g_wrapper, fen); }
 
-        for (size_t i = 0; i < moves.size(); ++i)
-        {
-            if (i > 0)
-                ss << " ";
-            ss << moves[i];
-        }
+    EXPORT_API void get_best_move(char *result, int max_length) { engine_get_best_move(g_wrapper, result, max_length); }
 
-        std::string movesStr = ss.str();
-        strncpy(result, movesStr.c_str(), max_length - 1);
-        result[max_length - 1] = '\0';
+    EXPORT_API void get_best_move_with_limits(char *result, int max_length,
+                                              int wtime, int btime, int winc, int binc,
+                                              int movestogo, int movetime, int depth,
+                                              long long nodes)
+    {
+        engine_get_best_move_with_limits(g_wrapper, result, max_length,
+                                         wtime, btime, winc, binc, movestogo, movetime, depth, nodes);
+    }
+
+    EXPORT_API bool start_search(int wtime, int btime, int winc, int binc,
+                                 int movestogo, int movetime, int depth, long long nodes)
+    {
+        return engine_start_search(g_wrapper, wtime, btime, winc, binc, movestogo, movetime, depth, nodes);
     }
-}
\ No newline at end of file
+
+    EXPORT_API bool poll_search_info(int *depth, int *score, long long *nodes, int *time_ms,
+                                     char *pv, int pv_length)
+    {
+        return engine_poll_search_info(g_wrapper, depth, score, nodes, time_ms, pv, pv_length);
+    }
+
+    EXPORT_API void wait_best_move(char *result, int max_length) { engine_wait_best_move(g_wrapper, result, max_length); }
+
+    EXPORT_API void stop_search() { engine_stop_search(g_wrapper); }
+
+    EXPORT_API void get_pv(char *result, int max_length) { engine_get_pv(g_wrapper, result, max_length); }
+
+    EXPORT_API void set_threads(int threads) { engine_set_threads(g_wrapper, threads); }
+
+    EXPORT_API bool make_move(const char *move) { return engine_make_move(g_wrapper, move); }
+
+    EXPORT_API void get_fen(char *result, int max_length) { engine_get_fen(g_wrapper, result, max_length); }
+
+    EXPORT_API bool is_game_over() { return engine_is_game_over(g_wrapper); }
+
+    EXPORT_API void reset_board() { engine_reset_board(g_wrapper); }
+
+    EXPORT_API bool is_move_legal(const char *move) { return engine_is_move_legal(g_wrapper, move); }
+
+    EXPORT_API bool is_in_check() { return engine_is_in_check(g_wrapper); }
+
+    EXPORT_API bool get_side_to_move() { return engine_get_side_to_move(g_wrapper); }
+
+    EXPORT_API int get_evaluation() { return engine_get_evaluation(g_wrapper); }
+
+    EXPORT_API int get_game_result() { return engine_get_game_result(g_wrapper); }
+
+    EXPORT_API void get_game_result_reason(char *result, int max_length)
+    {
+        engine_get_game_result_reason(g_wrapper, result, max_length);
+    }
+
+    EXPORT_API void get_legal_moves(char *result, int max_length) { engine_get_legal_moves(g_wrapper, result, max_length); }
+}
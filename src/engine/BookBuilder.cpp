@@ -0,0 +1,203 @@
+#include "BookBuilder.hpp"
+#include "MappedFile.hpp"
+#include "PgnTokenizer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    // Start of the next line beginning with '[' after from. Splitting there
+    // never cuts a game: at worst a chunk ends with some tags and no moves.
+    const char *nextTagLine(const char *from, const char *end)
+    {
+        while (from < end)
+        {
+            const void *newline = std::memchr(from, '\n', end - from);
+            if (!newline)
+            {
+                return end;
+            }
+            from = static_cast<const char *>(newline) + 1;
+            if (from < end && *from == '[')
+            {
+                return from;
+            }
+        }
+        return end;
+    }
+}
+
+BookBuilder::BookBuilder(int maxPlies, int threads)
+    : maxPlies(maxPlies), numThreads(std::max(1, threads)), shards(numThreads)
+{
+}
+
+bool BookBuilder::addFile(const std::string &path)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        std::cerr << "Failed to open PGN file: " << path << std::endl;
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const char *begin = file.data();
+    const char *end = begin + file.size();
+
+    // Several chunks per thread so a slow one does not hold up the rest
+    size_t chunkSize = std::clamp(file.size() / (numThreads * 8), MIN_CHUNK_SIZE, MAX_CHUNK_SIZE);
+    std::vector<const char *> bounds{begin};
+    while (bounds.back() < end)
+    {
+        size_t left = end - bounds.back();
+        bounds.push_back(left <= chunkSize ? end : nextTagLine(bounds.back() + chunkSize, end));
+    }
+    size_t chunks = bounds.size() - 1;
+
+    uint64_t fileIndex = stats.files;
+    std::atomic<size_t> nextChunk{0};
+    auto work = [&](Shard &shard)
+    {
+        for (size_t i = nextChunk++; i < chunks; i = nextChunk++)
+        {
+            countChunk(shard, begin, bounds[i], bounds[i + 1], fileIndex);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    int helpers = static_cast<int>(std::min<size_t>(numThreads, chunks)) - 1;
+    for (int i = 1; i <= helpers; i++)
+    {
+        workers.emplace_back(work, std::ref(shards[i]));
+    }
+    work(shards[0]);
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    stats.files++;
+    stats.bytes += file.size();
+    stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.games = stats.skippedGames = stats.positions = 0;
+    for (const auto &shard : shards)
+    {
+        stats.games += shard.games;
+        stats.skippedGames += shard.skippedGames;
+        stats.positions += shard.positions;
+    }
+    return true;
+}
+
+void BookBuilder::countChunk(Shard &shard, const char *fileBegin, const char *begin, const char *end, uint64_t fileIndex)
+{
+    // Copying the start position is much cheaper than parsing its FEN for every game
+    static const chess::Board startBoard;
+
+    PgnTokenizer tokenizer(begin, end);
+    std::string_view san;
+    while (!tokenizer.done())
+    {
+        chess::Board board = startBoard;
+        int ply = 0;
+        bool hasMoves = false;
+
+        while (tokenizer.next(san) == PgnTokenizer::Token::MOVE)
+        {
+            hasMoves = true;
+            if (ply >= maxPlies)
+            {
+                tokenizer.skipGame();
+                break;
+            }
+
+            chess::Move move = PgnTokenizer::sanToMove(board, san);
+            if (move == chess::Move::NULL_MOVE)
+            {
+                shard.skippedGames++;
+                tokenizer.skipGame();
+                break;
+            }
+
+            // The byte offset orders occurrences the same way a serial read would
+            uint64_t seen = (fileIndex << 40) | static_cast<uint64_t>(san.data() - fileBegin);
+            EntryCount &entry = shard.table[{board.hash(), PolyglotBook::encodeMove(move)}];
+            entry.count++;
+            entry.firstSeen = std::min(entry.firstSeen, seen);
+
+            board.makeMove(move);
+            ply++;
+            shard.positions++;
+        }
+
+        if (hasMoves)
+        {
+            shard.games++;
+        }
+    }
+}
+
+std::vector<PolyglotEntry> BookBuilder::entries() const
+{
+    CountTable merged;
+    for (const auto &shard : shards)
+    {
+        for (const auto &[key, count] : shard.table)
+        {
+            EntryCount &total = merged[key];
+            total.count += count.count;
+            total.firstSeen = std::min(total.firstSeen, count.firstSeen);
+        }
+    }
+
+    // Polyglot weights are 16 bit, scale the counts down if a move is more frequent
+    uint64_t maxCount = 1;
+    for (const auto &[key, count] : merged)
+    {
+        maxCount = std::max(maxCount, count.count);
+    }
+    double scale = std::min(1.0, 65535.0 / maxCount);
+
+    struct Ordered
+    {
+        PolyglotEntry entry;
+        uint64_t firstSeen;
+    };
+    std::vector<Ordered> ordered;
+    ordered.reserve(merged.size());
+    for (const auto &[key, count] : merged)
+    {
+        PolyglotEntry entry;
+        entry.key = key.key;
+        entry.move = key.move;
+        entry.weight = static_cast<uint16_t>(std::max<uint64_t>(1, static_cast<uint64_t>(count.count * scale)));
+        ordered.push_back({entry, count.firstSeen});
+    }
+
+    // Equal weights keep the order in which the moves first appeared
+    std::sort(ordered.begin(), ordered.end(), [](const Ordered &a, const Ordered &b)
+              {
+        if (a.entry.key != b.entry.key)
+            return a.entry.key < b.entry.key;
+        if (a.entry.weight != b.entry.weight)
+            return a.entry.weight > b.entry.weight;
+        return a.firstSeen < b.firstSeen; });
+
+    std::vector<PolyglotEntry> result;
+    result.reserve(ordered.size());
+    for (const auto &item : ordered)
+    {
+        result.push_back(item.entry);
+    }
+    return result;
+}
+
+bool BookBuilder::write(const std::string &path) const
+{
+    return PolyglotBook::write(path, entries());
+}
@@ -0,0 +1,89 @@
+#ifndef BOOK_BUILDER_HPP
+#define BOOK_BUILDER_HPP
+
+#include "PolyglotBook.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct BookBuildStats
+{
+    size_t files = 0;
+    size_t games = 0;
+    size_t skippedGames = 0; // games with a move that could not be read
+    size_t positions = 0;    // book moves counted, at most maxPlies per game
+    uint64_t bytes = 0;
+    double seconds = 0.0;
+};
+
+// Builds an opening book from many PGN files on several threads. Every file
+// is memory-mapped and cut into chunks at game boundaries; threads take
+// chunks from a shared counter and count (position, move) pairs in their own
+// table. Memory grows with the number of distinct book entries, not with the
+// input size.
+//
+// The tables are merged by summing counts and keeping the earliest place a
+// move was seen, so the book is the same for any number of threads and
+// matches what OpeningMove builds from the same files.
+class BookBuilder
+{
+public:
+    explicit BookBuilder(int maxPlies = 12, int threads = 1);
+
+    // Count the book moves of one PGN file
+    bool addFile(const std::string &path);
+
+    // Merged entries sorted by key, heaviest move first
+    std::vector<PolyglotEntry> entries() const;
+
+    bool write(const std::string &path) const;
+
+    const BookBuildStats &getStats() const { return stats; }
+
+private:
+    struct EntryKey
+    {
+        uint64_t key;
+        uint16_t move;
+        bool operator==(const EntryKey &other) const { return key == other.key && move == other.move; }
+    };
+
+    struct EntryKeyHash
+    {
+        size_t operator()(const EntryKey &entry) const
+        {
+            return static_cast<size_t>(entry.key ^ (entry.move * 0x9E3779B97F4A7C15ULL));
+        }
+    };
+
+    struct EntryCount
+    {
+        uint64_t count = 0;
+        uint64_t firstSeen = UINT64_MAX; // file index and byte offset of the first occurrence
+    };
+
+    using CountTable = std::unordered_map<EntryKey, EntryCount, EntryKeyHash>;
+
+    // Per-thread results, merged in entries()
+    struct Shard
+    {
+        CountTable table;
+        size_t games = 0;
+        size_t skippedGames = 0;
+        size_t positions = 0;
+    };
+
+    // Chunks smaller than this are not worth a separate task
+    static constexpr size_t MIN_CHUNK_SIZE = 256 * 1024;
+    static constexpr size_t MAX_CHUNK_SIZE = 16 * 1024 * 1024;
+
+    int maxPlies;
+    int numThreads;
+    std::vector<Shard> shards;
+    BookBuildStats stats;
+
+    void countChunk(Shard &shard, const char *fileBegin, const char *begin, const char *end, uint64_t fileIndex);
+};
+
+#endif // BOOK_BUILDER_HPP
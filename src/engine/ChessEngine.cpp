@@ -1,43 +1,161 @@
 #include "ChessEngine.hpp"
 #include "See.hpp"
+#include "MovePicker.hpp"
+#include <filesystem>
 #include <iomanip>
 
-ChessEngine::ChessEngine()
+ChessEngine::ChessEngine(bool loadOpeningBook)
     : rng(std::random_device{}()), tt(64)
 {
-    initializeOpeningBook();
+    pawnTables.push_back(std::make_unique<PawnHashTable>());
+    evalCaches.push_back(std::make_unique<EvalCache>());
+    if (loadOpeningBook)
+    {
+        initializeOpeningBook();
+    }
+    else
+    {
+        useOpeningBook = false;
+    }
+}
+
+ChessEngine::ChessEngine(std::shared_ptr<const OpeningMove> book)
+    : ChessEngine(false)
+{
+    openingBook = std::move(book);
+    useOpeningBook = openingBook != nullptr;
 }
 
 bool ChessEngine::initializeOpeningBook()
 {
     std::string path = "assets/opening/Adams.pgn";
+    // A book compiled with `make book` is mapped instead of parsing the PGN
+    std::string compiledPath = "assets/opening/Adams.bin";
+    if (std::filesystem::exists(compiledPath))
+    {
+        path = compiledPath;
+    }
     std::cout << "Initializing opening book!!!" << std::endl;
-    return openingBook.initializeFromFile(path);
+    return loadOpeningBook(path);
+}
+
+bool ChessEngine::loadOpeningBook(const std::string &path)
+{
+    // Load into a new book, the previous one may still be shared with other engines
+    auto book = std::make_shared<OpeningMove>();
+    if (maxBookMoves > 0)
+    {
+        book->setMaxBookMoves(maxBookMoves);
+    }
+    book->setSelection(bookSelection);
+    bool loaded = book->initializeFromFile(path);
+    openingBook = std::move(book);
+    return loaded;
 }
 
 void ChessEngine::setMaxBookMoves(int maxMoves)
 {
-    openingBook.setMaxBookMoves(maxMoves);
+    maxBookMoves = maxMoves;
+}
+
+void ChessEngine::setThreads(int threads)
+{
+    numThreads = std::max(1, threads);
+    tt.set_threads(numThreads);
+    pawnTables.resize(numThreads);
+    evalCaches.resize(numThreads);
+    for (int i = 0; i < numThreads; i++)
+    {
+        if (!pawnTables[i])
+            pawnTables[i] = std::make_unique<PawnHashTable>();
+        if (!evalCaches[i])
+            evalCaches[i] = std::make_unique<EvalCache>();
+    }
+}
+
+void ChessEngine::clearHash()
+{
+    tt.clear();
+    for (auto &table : pawnTables)
+    {
+        table->clear();
+    }
+    for (auto &cache : evalCaches)
+    {
+        cache->clear();
+    }
+}
+
+void ChessEngine::setHashSize(size_t sizeMb)
+{
+    tt.resize(sizeMb);
+}
+
+void ChessEngine::setMaxDepth(int depth)
+{
+    maxDepth = std::clamp(depth, 1, NUM_PLIES);
 }
 
 chess::Move ChessEngine::getBestMove(chess::Board &board)
 {
-    if (useOpeningBook)
+    SearchLimits limits;
+    limits.movetime = DEFAULT_MOVE_TIME;
+    limits.depth = maxDepth;
+    return getBestMove(board, limits);
+}
+
+chess::Move ChessEngine::getBestMove(chess::Board &board, const SearchLimits &limits)
+{
     {
-        chess::Move bookMove = openingBook.getBookMove(board);
+        std::lock_guard<std::mutex> lock(infoMutex);
+        searchInfo = SearchStats();
+    }
+    liveNodes.store(0, std::memory_order_relaxed);
+
+    std::vector<chess::Move> pv;
+    chess::Move bestMove = search(board, limits, pv);
+
+    std::lock_guard<std::mutex> lock(infoMutex);
+    lastPv = std::move(pv);
+    // Cleared at the end rather than the start so that a stop() racing the
+    // start of the search is not lost
+    stopRequested.store(false, std::memory_order_relaxed);
+    return bestMove;
+}
+
+ChessEngine::SearchStats ChessEngine::getSearchInfo() const
+{
+    std::lock_guard<std::mutex> lock(infoMutex);
+    SearchStats info = searchInfo;
+    info.nodes = std::max(info.nodes, liveNodes.load(std::memory_order_relaxed));
+    return info;
+}
+
+std::vector<chess::Move> ChessEngine::getLastPv() const
+{
+    std::lock_guard<std::mutex> lock(infoMutex);
+    return lastPv;
+}
+
+chess::Move ChessEngine::search(chess::Board &board, const SearchLimits &limits, std::vector<chess::Move> &pv)
+{
+    if (useOpeningBook && openingBook)
+    {
+        chess::Move bookMove = openingBook->getBookMove(board);
         if (bookMove != chess::Move::NULL_MOVE)
         {
-            std::cout << "Using opening book move: " << bookMove << std::endl;
+            if (verbose)
+                std::cout << "Using opening book move: " << bookMove << std::endl;
+            pv = {bookMove};
             moveCounter++;
             return bookMove;
         }
     }
 
-    startTime = std::chrono::steady_clock::now();
-    timeIsUp = false;
-
-    SearchStats stats;
-    stats.reset();
+    timeManager.start(limits, board.sideToMove());
+    pondering.store(limits.ponder, std::memory_order_relaxed);
+    depthLimit = limits.depth > 0 ? std::min(limits.depth, NUM_PLIES) : NUM_PLIES;
+    tt.increment_age();
 
     chess::Move bestMove = chess::Move::NULL_MOVE;
 
@@ -46,6 +164,7 @@ chess::Move ChessEngine::getBestMove(chess::Board &board)
 
     if (moves.size() == 1)
     {
+        pv = {moves[0]};
         moveCounter++;
         return moves[0];
     }
@@ -57,98 +176,359 @@ chess::Move ChessEngine::getBestMove(chess::Board &board)
 
     orderMoves(board, moves);
 
-    for (int depth = 1; depth <= MAX_DEPTH; depth++)
+    searchThreads.clear();
+    for (int i = 0; i < numThreads; i++)
+    {
+        searchThreads.push_back(std::make_unique<SearchThread>(i, board, *pawnTables[i], *evalCaches[i]));
+    }
+
+    std::vector<std::thread> helpers;
+    if (parallelMode == ParallelMode::SPLIT_POINT)
     {
-        if (timeIsUp) {
+        // Helpers wait in the pool until the main search opens a split point
+        splitShutdown = false;
+        idleWorkers = numThreads - 1;
+        for (int i = 1; i < numThreads; i++)
+        {
+            helpers.emplace_back([this, i]()
+                                 { splitWorker(*searchThreads[i]); });
+        }
+    }
+    else
+    {
+        // Lazy SMP: helpers search the same root on their own board copies and
+        // only cooperate through the shared transposition table
+        for (int i = 1; i < numThreads; i++)
+        {
+            helpers.emplace_back([this, i, moves]()
+                                 { iterativeDeepening(*searchThreads[i], moves); });
+        }
+    }
+
+    iterativeDeepening(*searchThreads[0], moves);
+
+    stopRequested = true;
+    {
+        std::lock_guard<std::mutex> lock(splitMutex);
+        splitShutdown = true;
+    }
+    splitCondition.notify_all();
+    for (auto &helper : helpers)
+    {
+        helper.join();
+    }
+    idleWorkers = 0;
+    lastSearchNodes = totalNodes();
+    liveNodes.store(lastSearchNodes, std::memory_order_relaxed);
+
+    // Take the deepest completed iteration, the main thread wins ties
+    const SearchThread *best = searchThreads[0].get();
+    for (const auto &thread : searchThreads)
+    {
+        if (thread->completedDepth > best->completedDepth &&
+            thread->bestMove != chess::Move::NULL_MOVE)
+        {
+            best = thread.get();
+        }
+    }
+    bestMove = best->bestMove;
+    pv = best->completedPv;
+
+    if (bestMove == chess::Move::NULL_MOVE && !moves.empty())
+    {
+        std::uniform_int_distribution<size_t> dist(0, moves.size() - 1);
+        bestMove = moves[dist(rng)];
+        pv = {bestMove};
+    }
+
+    auto totalTime = timeManager.elapsed();
+
+    if (verbose)
+    {
+        std::cout << "\nSearch completed in " << totalTime << "ms" << std::endl;
+        if (numThreads > 1)
+        {
+            std::cout << "Threads: " << numThreads
+                      << ", Selected thread: " << best->id
+                      << ", Depth: " << best->completedDepth
+                      << ", Total nodes: " << lastSearchNodes << std::endl;
+        }
+        std::cout << "Best move: " << chess::uci::moveToUci(bestMove) << std::endl;
+        std::cout << "---------------------------------------------------------" << std::endl;
+    }
+
+    searchThreads.clear();
+    moveCounter++;
+    return bestMove;
+}
+
+void ChessEngine::iterativeDeepening(SearchThread &thread, chess::Movelist moves)
+{
+    bool mainThread = thread.id == 0;
+
+    SearchStats stats;
+    stats.reset();
+
+    // Odd helpers start one ply deeper so the threads don't all walk the same tree in lockstep
+    int startDepth = 1 + (thread.id & 1);
+
+    for (int depth = startDepth; depth <= depthLimit; depth++)
+    {
+        if (stopRequested) {
             break;
         }
 
         stats.depth = depth;
         stats.reset();
 
-        int alpha = -32000;
-        int beta = 32000;
-
-        uint64_t nodes = 0;
-        int score;
+        // Aspiration window around the previous iteration's score, widened
+        // and re-searched whenever the result falls outside it
+        int delta = ASPIRATION_WINDOW;
+        int alpha = -INF;
+        int beta = INF;
+        if (depth >= ASPIRATION_MIN_DEPTH && thread.completedDepth > 0 &&
+            std::abs(thread.bestScore) < MATE_VALUE - NUM_PLIES)
+        {
+            alpha = std::max(-INF, thread.bestScore - delta);
+            beta = std::min(INF, thread.bestScore + delta);
+        }
 
         chess::Move currentBestMove = chess::Move::NULL_MOVE;
+        int score;
 
-        for (const auto &move : moves)
+        while (true)
         {
-            board.makeMove(move);
-            int moveScore = -negamax(board, depth - 1, 1, -beta, -alpha, nodes);
-            board.unmakeMove(move);
-            
-            if (timeIsUp) {
+            score = searchRoot(thread, moves, depth, alpha, beta, currentBestMove);
+            if (stopRequested) {
                 break;
             }
 
-            if (moveScore > alpha)
+            if (score <= alpha && alpha > -INF)
             {
-                alpha = moveScore;
-                currentBestMove = move;
+                alpha = std::max(-INF, alpha - delta);
             }
+            else if (score >= beta && beta < INF)
+            {
+                beta = std::min(INF, beta + delta);
+            }
+            else
+            {
+                break;
+            }
+            delta *= 2;
         }
 
-        if (!timeIsUp && currentBestMove != chess::Move::NULL_MOVE) {
-            bestMove = currentBestMove;
-            stats.bestMove = bestMove;
-            stats.score = alpha;
-            stats.nodes = nodes;
+        if (!stopRequested && currentBestMove != chess::Move::NULL_MOVE) {
+            thread.bestMove = currentBestMove;
+            thread.bestScore = score;
+            thread.completedDepth = depth;
+            thread.completedPv.assign(thread.pvTable[0].begin(), thread.pvTable[0].begin() + thread.pvLength[0]);
+            stats.bestMove = currentBestMove;
+            stats.score = score;
+            stats.nodes = totalNodes();
+            stats.pv = thread.completedPv;
+
+            // The next iteration starts down this PV, PVS relies on its first
+            // root move being searched first
+            int bestIndex = moves.find(currentBestMove);
+            std::rotate(moves.begin(), moves.begin() + bestIndex, moves.begin() + bestIndex + 1);
         }
 
-        auto currentTime = std::chrono::steady_clock::now();
-        std::chrono::milliseconds elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-            currentTime - startTime);
-        stats.duration = elapsed;
+        if (!mainThread) {
+            continue;
+        }
 
-        printSearchInfo(stats);
+        // An aborted iteration has nothing worth reporting
+        if (stopRequested) {
+            if (verbose)
+                std::cout << "Search stopped during depth " << depth << std::endl;
+            break;
+        }
+
+        stats.duration = std::chrono::milliseconds(timeManager.elapsed());
+        {
+            std::lock_guard<std::mutex> lock(infoMutex);
+            searchInfo = stats;
+        }
+        if (infoCallback) {
+            infoCallback(stats);
+        }
+        if (multiPv > 1) {
+            searchMultiPv(thread, moves, depth, stats);
+        }
 
-        TTStats ttStats = tt.get_stats();
-        std::cout << "TT Stats - Depth " << depth << ": "
-                  << "Size: " << ttStats.size << "/" << ttStats.capacity
-                  << ", Usage: " << std::fixed << std::setprecision(2) << ttStats.usage << "%"
-                  << ", Hit Rate: " << ttStats.hit_rate << "%"
-                  << ", Collisions: " << ttStats.collisions
-                  << std::endl;
+        if (verbose) {
+            printSearchInfo(stats);
+
+            TTStats ttStats = tt.get_stats();
+            std::cout << "TT Stats - Depth " << depth << ": "
+                      << "Size: " << ttStats.size << "/" << ttStats.capacity
+                      << ", Usage: " << std::fixed << std::setprecision(2) << ttStats.usage << "%"
+                      << ", Hit Rate: " << ttStats.hit_rate << "%"
+                      << ", Collisions: " << ttStats.collisions
+                      << ", Current gen: " << ttStats.current_generation
+                      << std::endl;
+
+            PawnHashStats pawnStats = thread.pawnTable.get_stats();
+            std::cout << "Pawn Hash Stats - Depth " << depth << ": "
+                      << "Capacity: " << pawnStats.capacity
+                      << ", Hit Rate: " << pawnStats.hit_rate << "%"
+                      << ", Hits: " << pawnStats.hits
+                      << ", Misses: " << pawnStats.misses
+                      << std::endl;
+
+            EvalCacheStats evalStats = thread.evalCache.get_stats();
+            std::cout << "Eval Cache Stats - Depth " << depth << ": "
+                      << "Capacity: " << evalStats.capacity
+                      << ", Hit Rate: " << evalStats.hit_rate << "%"
+                      << ", Hits: " << evalStats.hits
+                      << ", Misses: " << evalStats.misses
+                      << std::endl;
+        }
 
-        if (elapsed.count() > TIME_LIMIT * 1000) {
-            timeIsUp = true;
-            std::cout << "Time limit reached after depth " << depth << std::endl;
+        if (!pondering.load(std::memory_order_relaxed) &&
+            timeManager.iterationDone(thread.bestMove, thread.bestScore, totalNodes())) {
+            stopRequested = true;
+            if (verbose)
+                std::cout << "Search limit reached after depth " << depth << std::endl;
             break;
         }
     }
+}
 
-    if (bestMove == chess::Move::NULL_MOVE && !moves.empty())
+void ChessEngine::searchMultiPv(SearchThread &thread, const chess::Movelist &moves, int depth,
+                                const SearchStats &best)
+{
+    // moves[0] is the best move of this iteration
+    chess::Movelist remaining;
+    for (int i = 1; i < moves.size(); i++)
     {
-        std::uniform_int_distribution<size_t> dist(0, moves.size() - 1);
-        bestMove = moves[dist(rng)];
+        remaining.add(moves[i]);
     }
 
-    auto endTime = std::chrono::steady_clock::now();
-    auto totalTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+    for (int line = 2; line <= multiPv && !remaining.empty(); line++)
+    {
+        chess::Move lineMove;
+        int score = searchRoot(thread, remaining, depth, -INF, INF, lineMove);
+        if (stopRequested || lineMove == chess::Move::NULL_MOVE)
+        {
+            return;
+        }
 
-    std::cout << "\nSearch completed in " << totalTime << "ms" << std::endl;
-    std::cout << "Best move: " << chess::uci::moveToUci(bestMove) << std::endl;
-    std::cout << "---------------------------------------------------------" << std::endl;
+        SearchStats stats = best;
+        stats.pvIndex = line;
+        stats.score = score;
+        stats.bestMove = lineMove;
+        stats.pv.assign(thread.pvTable[0].begin(), thread.pvTable[0].begin() + thread.pvLength[0]);
+        stats.nodes = totalNodes();
+        stats.duration = std::chrono::milliseconds(timeManager.elapsed());
+        if (infoCallback)
+        {
+            infoCallback(stats);
+        }
 
-    moveCounter++;
-    return bestMove;
+        // The next line is the best among the moves not reported yet
+        chess::Movelist next;
+        for (const auto &move : remaining)
+        {
+            if (move != lineMove)
+                next.add(move);
+        }
+        remaining = next;
+    }
 }
 
-int ChessEngine::negamax(chess::Board &board, int depth, int ply, int alpha, int beta, uint64_t &nodes)
+int ChessEngine::getHashfull() const
 {
-    if ((nodes & 1023) == 0) {
-        auto currentTime = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - startTime).count();
-        if (elapsed > TIME_LIMIT * 1000) {
-            timeIsUp = true;
-            return alpha;
+    TTStats stats = tt.get_stats();
+    return stats.capacity > 0 ? static_cast<int>(stats.current_generation * 1000 / stats.capacity) : 0;
+}
+
+int ChessEngine::searchRoot(SearchThread &thread, const chess::Movelist &moves, int depth,
+                            int alpha, int beta, chess::Move &bestMove)
+{
+    EvalBoard &board = thread.board;
+    bestMove = chess::Move::NULL_MOVE;
+    thread.clearPv(0);
+
+    for (int i = 0; i < moves.size(); i++)
+    {
+        chess::Move move = moves[i];
+        thread.followPv = i == 0 && !thread.completedPv.empty() && move == thread.completedPv[0];
+        thread.heuristics.setCurrentMove(0, move);
+        board.makeMove(move);
+
+        // PVS: only the first move gets the full window, the rest just have to
+        // prove they are no better and are re-searched if they are
+        int moveScore;
+        if (i == 0)
+        {
+            moveScore = -negamax(board, depth - 1, 1, -beta, -alpha, thread);
+        }
+        else
+        {
+            moveScore = -negamax(board, depth - 1, 1, -alpha - 1, -alpha, thread);
+            if (moveScore > alpha && moveScore < beta && !stopRequested)
+            {
+                moveScore = -negamax(board, depth - 1, 1, -beta, -alpha, thread);
+            }
+        }
+        board.unmakeMove(move);
+
+        if (stopRequested) {
+            break;
+        }
+
+        if (moveScore > alpha)
+        {
+            alpha = moveScore;
+            bestMove = move;
+            thread.updatePv(0, move);
+            if (alpha >= beta)
+            {
+                break;
+            }
+        }
+    }
+
+    return alpha;
+}
+
+uint64_t ChessEngine::totalNodes() const
+{
+    uint64_t nodes = 0;
+    for (const auto &thread : searchThreads)
+    {
+        nodes += thread->nodes.load(std::memory_order_relaxed);
+    }
+    return nodes;
+}
+
+bool ChessEngine::limitReached(SearchThread &thread)
+{
+    if (--thread.stopCheckCountdown <= 0)
+    {
+        thread.stopCheckCountdown = STOP_CHECK_INTERVAL;
+        uint64_t nodes = totalNodes();
+        liveNodes.store(nodes, std::memory_order_relaxed);
+        if (!pondering.load(std::memory_order_relaxed) && timeManager.hardLimitReached(nodes))
+        {
+            stopRequested.store(true, std::memory_order_relaxed);
         }
     }
+    return stopRequested.load(std::memory_order_relaxed);
+}
+
+int ChessEngine::negamax(EvalBoard &board, int depth, int ply, int alpha, int beta, SearchThread &thread,
+                         bool allowNull)
+{
+    thread.clearPv(ply);
+
+    if (limitReached(thread)) {
+        return alpha;
+    }
 
-    nodes++;
+    thread.countNode();
 
     if (alpha < -CHECKMATE_SCORE + ply)
         alpha = -CHECKMATE_SCORE + ply;
@@ -164,131 +544,240 @@ int ChessEngine::negamax(chess::Board &board, int depth, int ply, int alpha, int
 
     if (depth <= 0)
     {
-        return quiesence(board, alpha, beta, nodes, ply);
+        return quiesence(board, alpha, beta, thread, ply);
     }
 
 
     uint64_t hashKey = board.hash();
-    auto [found, score] = tt.lookup(hashKey, depth, alpha, beta);
-    if (found)
+    TTProbe ttProbe = tt.lookup(hashKey, depth, alpha, beta, thread.id);
+    // PV nodes are searched even on a hit so the principal variation stays complete
+    if (ttProbe.cutoff && beta - alpha == 1)
     {
-        return score;
+        return ttProbe.score;
     }
 
+    bool inCheck = board.inCheck();
 
-    chess::Movelist moves;
-    chess::movegen::legalmoves(moves, board);
-
-    if (moves.empty())
+    // Null-move pruning: if passing still fails high the position is good enough
+    // to cut. Not done at PV nodes, in check, without pieces (zugzwang) or right
+    // after a null move.
+    if (allowNull && !inCheck && depth >= NULL_MOVE_MIN_DEPTH && beta - alpha == 1 &&
+        std::abs(beta) < MATE_VALUE - NUM_PLIES && hasNonPawnMaterial(board))
     {
-        if (board.inCheck())
-        {
-            return -CHECKMATE_SCORE + ply;
-        }
-        else
+        int staticEval = evaluatePosition(board, thread);
+        if (staticEval >= beta)
         {
-            return DRAW_SCORE;
+            int R = 3 + depth / 6 + std::min((staticEval - beta) / NULL_MOVE_EVAL_MARGIN, 3);
+            int nullDepth = std::max(0, depth - 1 - R);
+
+            // Neither the null move nor the verification search follow the PV
+            bool followPv = thread.followPv;
+            thread.followPv = false;
+
+            thread.heuristics.setCurrentMove(ply, chess::Move::NULL_MOVE);
+            board.makeNullMove();
+            int nullScore = -negamax(board, nullDepth, ply + 1, -beta, -beta + 1, thread, false);
+            board.unmakeNullMove();
+
+            if (shouldStop(thread)) {
+                return alpha;
+            }
+
+            if (nullScore >= beta)
+            {
+                // Deep cutoffs are verified by a reduced search without null moves
+                if (depth < NULL_MOVE_VERIFY_DEPTH)
+                {
+                    return beta;
+                }
+                int verifyScore = negamax(board, nullDepth, ply, beta - 1, beta, thread, false);
+                if (!shouldStop(thread) && verifyScore >= beta)
+                {
+                    return beta;
+                }
+            }
+            thread.followPv = followPv;
         }
     }
 
-    orderMoves(board, moves);
+    // Moves are generated and ordered lazily, a cut node often never needs the quiets
+    // On the previous PV its move stands in for a missing TT move
+    chess::Move pvMove = thread.pvMove(ply);
+    MovePicker picker(board, ttProbe.move != chess::Move::NO_MOVE ? ttProbe.move : pvMove,
+                      thread.heuristics, ply);
 
     int bestScore = -INF;
     int alphaOriginal = alpha;
     chess::Move bestMove = chess::Move::NULL_MOVE;
+    chess::Movelist quietsTried;
+    int moveCount = 0;
+    chess::Move move;
 
-    for (int i = 0; i < moves.size(); i++)
+    while ((move = picker.next()) != chess::Move::NO_MOVE)
     {
-        if ((nodes & 1023) == 0) {
-            auto currentTime = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - startTime).count();
-            if (elapsed > TIME_LIMIT * 1000) {
-                timeIsUp = true;
-                break;
-            }
+        bool quiet = isQuiet(board, move);
+        if (move != pvMove)
+        {
+            thread.followPv = false;
         }
 
-        chess::Move move = moves[i];
-
-
-        bool isReduced = false;
-        bool isCapture = board.at(move.to()) != chess::Piece::NONE;
-        bool isPromotion = move.typeOf() == chess::Move::PROMOTION;
-        bool givesCheck = false;
-
-
-        board.makeMove(move);
+        int score = searchMove(board, move, moveCount, depth, ply, alpha, beta, thread);
+        moveCount++;
 
+        if (shouldStop(thread)) {
+            break;
+        }
 
-        givesCheck = board.inCheck();
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestMove = move;
+        }
 
-        int newDepth = depth - 1;
+        if (score > alpha)
+        {
+            alpha = score;
 
+            if (alpha >= beta)
+            {
+                if (quiet)
+                {
+                    thread.heuristics.updateQuiet(board, move, depth, ply, quietsTried);
+                }
+                tt.store(hashKey, beta, TTFlag::LOWER_BOUND, depth, move, thread.id);
+                return beta;
+            }
+            thread.updatePv(ply, move);
+        }
 
-        if (depth >= 3 && i >= 4 && !isCapture && !isPromotion && !givesCheck)
+        if (quiet)
         {
-            isReduced = true;
-            newDepth = depth - 2;
+            quietsTried.add(move);
         }
 
+        // Young Brothers Wait: once the eldest brother is searched the
+        // remaining moves may be shared with idle helper threads
+        if (moveCount == 1 && canSplit(depth))
+        {
+            chess::Movelist splitMoves;
+            splitMoves.add(move);
+            for (chess::Move rest = picker.next(); rest != chess::Move::NO_MOVE; rest = picker.next())
+            {
+                splitMoves.add(rest);
+            }
+            if (splitMoves.size() == 1)
+            {
+                break;
+            }
 
-        int score;
-
+            thread.followPv = false;
+            splitSearch(board, splitMoves, depth, ply, alpha, beta, bestScore, bestMove, thread);
 
-        if (isReduced)
-        {
-            score = -negamax(board, newDepth, ply + 1, -alpha - 1, -alpha, nodes);
+            // Lines found by helpers stay in their own PV tables, keep just the move
+            if (alpha > alphaOriginal && (thread.pvLength[ply] == 0 || thread.pvTable[ply][0] != bestMove))
+            {
+                thread.clearPv(ply + 1);
+                thread.updatePv(ply, bestMove);
+            }
 
-            if (score > alpha && !timeIsUp)
+            if (!shouldStop(thread) && alpha >= beta)
             {
-                score = -negamax(board, depth - 1, ply + 1, -beta, -alpha, nodes);
+                tt.store(hashKey, beta, TTFlag::LOWER_BOUND, depth, bestMove, thread.id);
+                return beta;
             }
+            break;
+        }
+    }
+
+    if (shouldStop(thread)) {
+        return alpha;
+    }
+
+    if (moveCount == 0)
+    {
+        if (inCheck)
+        {
+            return -CHECKMATE_SCORE + ply;
         }
         else
         {
-
-            score = -negamax(board, newDepth, ply + 1, -beta, -alpha, nodes);
+            return DRAW_SCORE;
         }
+    }
 
+    TTFlag flag = alpha > alphaOriginal ? TTFlag::EXACT_SCORE : TTFlag::UPPER_BOUND;
+    tt.store(hashKey, bestScore, flag, depth, bestMove, thread.id);
 
-        board.unmakeMove(move);
+    return bestScore;
+}
 
+bool ChessEngine::hasNonPawnMaterial(const chess::Board &board)
+{
+    chess::Color us = board.sideToMove();
+    return board.pieces(chess::PieceType::KNIGHT, us) || board.pieces(chess::PieceType::BISHOP, us) ||
+           board.pieces(chess::PieceType::ROOK, us) || board.pieces(chess::PieceType::QUEEN, us);
+}
 
-        if (timeIsUp) {
-            break;
-        }
+int ChessEngine::searchMove(EvalBoard &board, chess::Move move, int moveIndex, int depth, int ply,
+                            int alpha, int beta, SearchThread &thread)
+{
+    bool isReduced = false;
+    bool isCapture = board.at(move.to()) != chess::Piece::NONE;
+    bool isPromotion = move.typeOf() == chess::Move::PROMOTION;
+    bool givesCheck = false;
 
-        if (score > bestScore)
+
+    thread.heuristics.setCurrentMove(ply, move);
+    board.makeMove(move);
+
+
+    givesCheck = board.inCheck();
+
+    int newDepth = depth - 1;
+
+
+    if (depth >= 3 && moveIndex >= 4 && !isCapture && !isPromotion && !givesCheck)
+    {
+        isReduced = true;
+        newDepth = depth - 2;
+    }
+
+
+    int score;
+
+    if (moveIndex == 0)
+    {
+        score = -negamax(board, newDepth, ply + 1, -beta, -alpha, thread);
+    }
+    else
+    {
+        // PVS: a zero window search proves the move is no better than alpha,
+        // a reduced one is verified at full depth before the full window re-search
+        score = -negamax(board, newDepth, ply + 1, -alpha - 1, -alpha, thread);
+
+        if (isReduced && score > alpha && !shouldStop(thread))
         {
-            bestScore = score;
-            bestMove = move;
+            score = -negamax(board, depth - 1, ply + 1, -alpha - 1, -alpha, thread);
         }
 
-        if (score > alpha)
+        if (score > alpha && score < beta && !shouldStop(thread))
         {
-            alpha = score;
-
-            if (alpha >= beta)
-            {
-                tt.store(hashKey, beta, TTFlag::LOWER_BOUND, depth);
-                return beta;
-            }
+            score = -negamax(board, depth - 1, ply + 1, -beta, -alpha, thread);
         }
     }
 
-    if (timeIsUp) {
-        return alpha;
-    }
-
-    TTFlag flag = alpha > alphaOriginal ? TTFlag::EXACT_SCORE : TTFlag::UPPER_BOUND;
-    tt.store(hashKey, bestScore, flag, depth);
+    board.unmakeMove(move);
 
-    return bestScore;
+    return score;
 }
 
-int ChessEngine::quiesence(chess::Board &board, int alpha, int beta, uint64_t &nodes, int ply)
+int ChessEngine::quiesence(EvalBoard &board, int alpha, int beta, SearchThread &thread, int ply, int qsPly)
 {
-    nodes++;
+    if (limitReached(thread)) {
+        return alpha;
+    }
+
+    thread.countNode();
     
     if (alpha < -CHECKMATE_SCORE + ply) alpha = -CHECKMATE_SCORE + ply;
     if (beta > CHECKMATE_SCORE - ply) beta = CHECKMATE_SCORE - ply;
@@ -300,25 +789,26 @@ int ChessEngine::quiesence(chess::Board &board, int alpha, int beta, uint64_t &n
         return DRAW_SCORE;
     }
     
+    // qsPly counts captures since the horizon, ply the distance from the root
     const int MAX_QUIESCENCE_DEPTH = 10;
-    if (ply >= MAX_QUIESCENCE_DEPTH)
-        return evaluatePosition(board);
+    if (qsPly >= MAX_QUIESCENCE_DEPTH || ply >= MAX_PLY - 1)
+        return evaluatePosition(board, thread);
         
     bool inCheck = board.inCheck();
     uint64_t hashKey = board.hash();
-    auto [hit, score] = tt.lookup(hashKey, 0, alpha, beta);
-    
-    if (hit)
+    TTProbe ttProbe = tt.lookup(hashKey, 0, alpha, beta, thread.id);
+
+    if (ttProbe.cutoff)
     {
-        return score;
+        return ttProbe.score;
     }
 
     if (!inCheck)
     {
-        int standPat = evaluatePosition(board);
+        int standPat = evaluatePosition(board, thread);
         if (standPat >= beta)
         {
-            tt.store(hashKey, beta, TTFlag::LOWER_BOUND, 0);
+            tt.store(hashKey, beta, TTFlag::LOWER_BOUND, 0, chess::Move::NO_MOVE, thread.id);
             return beta;
         }
         if (standPat > alpha)
@@ -335,7 +825,7 @@ int ChessEngine::quiesence(chess::Board &board, int alpha, int beta, uint64_t &n
     else
     {
         chess::movegen::legalmoves<chess::MoveGenType::CAPTURE>(moves, board);
-        orderMoves(board, moves);
+        orderMoves(board, moves, ttProbe.move);
     }
 
     for (const auto &move : moves)
@@ -347,13 +837,17 @@ int ChessEngine::quiesence(chess::Board &board, int alpha, int beta, uint64_t &n
 
         board.makeMove(move);
 
-        int score = -quiesence(board, -beta, -alpha, nodes, ply + 1);
+        int score = -quiesence(board, -beta, -alpha, thread, ply + 1, qsPly + 1);
 
         board.unmakeMove(move);
 
+        if (shouldStop(thread)) {
+            return alpha;
+        }
+
         if (score >= beta)
         {
-            tt.store(hashKey, beta, TTFlag::LOWER_BOUND, 0);
+            tt.store(hashKey, beta, TTFlag::LOWER_BOUND, 0, move, thread.id);
             return beta;
         }
         if (score > alpha)
@@ -365,24 +859,39 @@ int ChessEngine::quiesence(chess::Board &board, int alpha, int beta, uint64_t &n
         return -CHECKMATE_SCORE + ply;
     }
 
-    tt.store(hashKey, alpha, TTFlag::UPPER_BOUND, 0);
+    tt.store(hashKey, alpha, TTFlag::UPPER_BOUND, 0, chess::Move::NO_MOVE, thread.id);
     return alpha;
 }
 
-void ChessEngine::orderMoves(chess::Board &board, chess::Movelist &moves)
+void ChessEngine::orderMoves(chess::Board &board, chess::Movelist &moves, chess::Move ttMove)
 {
 
     for (auto &move : moves)
     {
-        scoreMoves(board, move);
+        scoreMoves(board, move, ttMove);
     }
 
 
     moves.sort();
 }
 
-void ChessEngine::scoreMoves(const chess::Board &board, chess::Move &move)
+bool ChessEngine::isQuiet(const chess::Board &board, chess::Move move)
+{
+    // Castling is encoded as king takes own rook, so check it before the capture test
+    if (move.typeOf() == chess::Move::CASTLING)
+        return true;
+    return move.typeOf() == chess::Move::NORMAL && board.at(move.to()) == chess::Piece::NONE;
+}
+
+void ChessEngine::scoreMoves(const chess::Board &board, chess::Move &move, chess::Move ttMove)
 {
+    // Hash move from the TT is searched first
+    if (move == ttMove)
+    {
+        move.setScore(HASH_MOVE_SCORE);
+        return;
+    }
+
     int score = 0;
 
     if (board.at(move.to()) != chess::Piece::NONE)
@@ -422,13 +931,19 @@ void ChessEngine::scoreMoves(const chess::Board &board, chess::Move &move)
             score += 300;
     }
 
-
-    move.setScore(score);
+    // Move scores are 16 bit, keep queen promotions from wrapping around
+    move.setScore(std::min(score, HASH_MOVE_SCORE - 1));
 }
 
-int ChessEngine::evaluatePosition(const chess::Board &board)
+int ChessEngine::evaluatePosition(const EvalBoard &board, SearchThread &thread)
 {
-    int score = evaluation.evaluate(board);
+    int score;
+    if (thread.evalCache.probe(board.hash(), score))
+    {
+        return score;
+    }
+    score = evaluation.evaluate(board, thread.pawnTable);
+    thread.evalCache.store(board.hash(), score);
     return score;
 }
 
@@ -443,5 +958,10 @@ void ChessEngine::printSearchInfo(const SearchStats &stats)
               << ", Time: " << timeInMs
               << ", NPS: " << nps
               << ", Best Move: " << stats.bestMove
-              << std::endl;
+              << ", PV:";
+    for (const auto &move : stats.pv)
+    {
+        std::cout << " " << chess::uci::moveToUci(move);
+    }
+    std::cout << std::endl;
 }
\ No newline at end of file
@@ -3,31 +3,145 @@
 
 #include "../chess.hpp"
 #include "Evaluation.hpp"
+#include "EvalBoard.hpp"
 #include "OpeningMove.hpp"
 #include "transposition_table.hpp"
+#include "eval_cache.hpp"
+#include "SplitPoint.hpp"
+#include "SearchHeuristics.hpp"
+#include "TimeManager.hpp"
 #include <vector>
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <chrono>
 #include <iostream>
 #include <limits>
 #include <random>
+#include <functional>
 
 class ChessEngine
 {
 public:
-    ChessEngine();
+    // How extra search threads are used
+    enum class ParallelMode
+    {
+        LAZY_SMP,   // helpers search the whole root and share the TT
+        SPLIT_POINT // Young Brothers Wait: sibling moves are shared at split nodes
+    };
+
+    struct SearchStats
+    {
+        int depth = 0;
+        int score = 0;
+        uint64_t nodes = 0;
+        std::chrono::milliseconds duration{0};
+        chess::Move bestMove = chess::Move::NULL_MOVE;
+        std::vector<chess::Move> pv; // principal variation, starts with bestMove
+        int pvIndex = 1;             // MultiPV line, 1 is the best
+
+        void reset()
+        {
+            nodes = 0;
+            score = 0;
+            bestMove = chess::Move::NULL_MOVE;
+            pv.clear();
+        }
+    };
+
+    explicit ChessEngine(bool loadOpeningBook = true);
+
+    // Use an already loaded opening book, shared read-only with other engines
+    explicit ChessEngine(std::shared_ptr<const OpeningMove> book);
     ~ChessEngine() = default;
 
+    // Search with DEFAULT_MOVE_TIME and the depth set by setMaxDepth
     chess::Move getBestMove(chess::Board &board);
 
+    // Search within clock, move time, depth and node limits
+    chess::Move getBestMove(chess::Board &board, const SearchLimits &limits);
+
     bool initializeOpeningBook();
 
+    // Load a PGN file or a Polyglot .bin book in place of the current book
+    bool loadOpeningBook(const std::string &path);
+
+    // Plies read from each book game, applies to the next book load
     void setMaxBookMoves(int maxMoves);
 
+    // How book moves are picked, applies to the next book load
+    void setBookSelection(OpeningMove::Selection selection) { bookSelection = selection; }
+
+    std::shared_ptr<const OpeningMove> getOpeningBook() const { return openingBook; }
+
     void enableOpeningBook(bool enable) { useOpeningBook = enable; }
 
+    // Number of search threads, including the main one
+    void setThreads(int threads);
+
+    int getThreads() const { return numThreads; }
+
+    void setParallelMode(ParallelMode mode) { parallelMode = mode; }
+
+    ParallelMode getParallelMode() const { return parallelMode; }
+
+    // Depth limit of getBestMove without explicit limits
+    void setMaxDepth(int depth);
+
+    // Print per-depth search info and TT stats to stdout
+    void setVerbose(bool enable) { verbose = enable; }
+
+    // Called on the main search thread after every completed iteration, once
+    // per MultiPV line
+    using InfoCallback = std::function<void(const SearchStats &)>;
+    void setInfoCallback(InfoCallback callback) { infoCallback = std::move(callback); }
+
+    // Number of best root moves reported with their own PV, the extra lines
+    // cost one additional root search each
+    void setMultiPv(int lines) { multiPv = std::clamp(lines, 1, 256); }
+
+    int getMultiPv() const { return multiPv; }
+
+    // Share of the transposition table written during the current search, in permille
+    int getHashfull() const;
+
+    void clearHash();
+
+    // Replace the transposition table with an empty one of about sizeMb megabytes,
+    // must not be called while a search is running
+    void setHashSize(size_t sizeMb);
+
+    // Abort the running getBestMove as soon as possible, safe to call from any
+    // thread. The search returns the best move of the last completed iteration.
+    // A stop() while no search runs ends the next one right away, callers
+    // that launch searches from another thread drop such stale stops with
+    // clearStop() before starting.
+    void stop() { stopRequested.store(true, std::memory_order_relaxed); }
+
+    void clearStop() { stopRequested.store(false, std::memory_order_relaxed); }
+
+    // The pondered move was played: from now on the limits of a ponder search
+    // apply, time spent pondering counts towards them
+    void ponderHit() { pondering.store(false, std::memory_order_relaxed); }
+
+    // Snapshot of the running (or last) search for another thread: the last
+    // completed iteration of the main thread plus the current node count
+    SearchStats getSearchInfo() const;
+
+    // Nodes searched by all threads during the last getBestMove call
+    uint64_t getLastSearchNodes() const { return lastSearchNodes; }
+
+    // Principal variation of the last getBestMove call, best move first
+    std::vector<chess::Move> getLastPv() const;
+
     static constexpr int MAX_DEPTH = 7;
-    static constexpr int TIME_LIMIT = 10;
+    static constexpr int DEFAULT_MOVE_TIME = 10000; // ms
     static constexpr int GOOD_CAPTURE_WEIGHT = 5000;
+    static constexpr int HASH_MOVE_SCORE = std::numeric_limits<int16_t>::max();
     static constexpr int INF = 32000;
     // Define a mate score that's well below the infinity limit but leaves room for ply adjustment
     static constexpr int MATE_VALUE = 30000;
@@ -35,43 +149,171 @@ public:
     static constexpr int DRAW_SCORE = 0;
 
 private:
-    // Constants for searchMoves arrays
     static constexpr int NUM_PLIES = 64;
-    static constexpr int NUM_MOVES = 256;
-    OpeningMove openingBook;
+    static constexpr int MAX_PLY = SearchHeuristics::MAX_PLY;
+    std::shared_ptr<const OpeningMove> openingBook; // null without a book
+    int maxBookMoves = 0;                           // 0 keeps OpeningMove's default
+    OpeningMove::Selection bookSelection = OpeningMove::Selection::BEST_WEIGHT;
     bool useOpeningBook = true;
     int moveCounter = 0;
 
+    int numThreads = 1;
+    ParallelMode parallelMode = ParallelMode::LAZY_SMP;
+    int maxDepth = MAX_DEPTH;
+    bool verbose = true;
+    int multiPv = 1;
+    InfoCallback infoCallback;
+    uint64_t lastSearchNodes = 0;
+    std::vector<chess::Move> lastPv;          // guarded by infoMutex
+
+    // Progress shared with getSearchInfo, written once per iteration
+    mutable std::mutex infoMutex;
+    SearchStats searchInfo;                   // guarded by infoMutex
+    std::atomic<uint64_t> liveNodes{0};       // refreshed at every stop check
+
+    // Body of getBestMove, the caller publishes pv and resets the stop flag
+    chess::Move search(chess::Board &board, const SearchLimits &limits, std::vector<chess::Move> &pv);
+
+    // Aspiration windows at the root
+    static constexpr int ASPIRATION_MIN_DEPTH = 4;
+    static constexpr int ASPIRATION_WINDOW = 100;
+
+    // Null-move pruning
+    static constexpr int NULL_MOVE_MIN_DEPTH = 3;
+    static constexpr int NULL_MOVE_VERIFY_DEPTH = 6; // re-check null cutoffs with a real search from here
+    static constexpr int NULL_MOVE_EVAL_MARGIN = 200; // eval above beta per extra ply of reduction
+
+    // Split point search
+    static constexpr int MIN_SPLIT_DEPTH = 4;
+    std::mutex splitMutex;
+    std::condition_variable splitCondition;
+    std::vector<SplitPoint *> activeSplitPoints; // guarded by splitMutex
+    bool splitShutdown = false;                  // guarded by splitMutex
+    std::atomic<int> idleWorkers{0};
+
     // Time management
-    bool timeIsUp = false;
-    std::chrono::time_point<std::chrono::steady_clock> startTime;
+    static constexpr int STOP_CHECK_INTERVAL = 1024; // nodes between clock polls per thread
+    std::atomic<bool> stopRequested{false};          // set by the time manager or stop()
+    std::atomic<bool> pondering{false};              // limits are ignored until ponderHit()
+    TimeManager timeManager;
+    int depthLimit = MAX_DEPTH; // of the running search
 
-    struct SearchStats
+    // Per-thread search state. Every thread searches its own copy of the root
+    // board and only the transposition table is shared between them.
+    struct alignas(64) SearchThread
     {
-        int depth = 0;
-        int score = 0;
-        uint64_t nodes = 0;
-        std::chrono::milliseconds duration;
+        SearchThread(int id, const chess::Board &board, PawnHashTable &pawnTable, EvalCache &evalCache)
+            : id(id), board(board), pawnTable(pawnTable), evalCache(evalCache) {}
+
+        int id;
+        EvalBoard board;
+        // Owned by the engine so they survive between searches
+        PawnHashTable &pawnTable;
+        EvalCache &evalCache;
+        std::atomic<uint64_t> nodes{0};
+        int stopCheckCountdown = STOP_CHECK_INTERVAL; // nodes until the next clock poll
+        SplitPoint *splitPoint = nullptr; // innermost split point this thread is working on
+        SearchHeuristics heuristics;      // killers, history and countermoves for this search
+
+        // Result of the last fully completed iteration
+        int completedDepth = 0;
+        int bestScore = 0;
         chess::Move bestMove = chess::Move::NULL_MOVE;
+        std::vector<chess::Move> completedPv;
 
-        void reset()
+        // Triangular PV table: pvTable[ply] holds the best line found from ply on
+        std::array<std::array<chess::Move, MAX_PLY>, MAX_PLY> pvTable;
+        std::array<int, MAX_PLY> pvLength{};
+        // Still on the previous iteration's PV, its moves are tried first
+        bool followPv = false;
+
+        // Only the owning thread writes, others may read the count concurrently
+        void countNode() { nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+        void clearPv(int ply)
         {
-            nodes = 0;
-            score = 0;
-            bestMove = chess::Move::NULL_MOVE;
+            if (ply < MAX_PLY)
+                pvLength[ply] = 0;
+        }
+
+        // move became the best at ply, the line below it is the child's PV
+        void updatePv(int ply, chess::Move move)
+        {
+            if (ply >= MAX_PLY)
+                return;
+            pvTable[ply][0] = move;
+            int childLength = 0;
+            if (ply + 1 < MAX_PLY)
+            {
+                childLength = std::min(pvLength[ply + 1], MAX_PLY - 1);
+                std::copy_n(pvTable[ply + 1].begin(), childLength, pvTable[ply].begin() + 1);
+            }
+            pvLength[ply] = childLength + 1;
+        }
+
+        // Move of the previous iteration's PV at ply while the search still follows it
+        chess::Move pvMove(int ply) const
+        {
+            return followPv && ply < static_cast<int>(completedPv.size()) ? completedPv[ply] : chess::Move::NO_MOVE;
         }
     };
 
-    int negamax(chess::Board &board, int depth, int ply, int alpha, int beta,
-                uint64_t &nodes);
+    void iterativeDeepening(SearchThread &thread, chess::Movelist moves);
+
+    // Search and report MultiPV lines 2 and up once the best line of the iteration is known
+    void searchMultiPv(SearchThread &thread, const chess::Movelist &moves, int depth, const SearchStats &best);
+
+    // One root iteration with PVS, returns alpha (a bound when outside the window)
+    int searchRoot(SearchThread &thread, const chess::Movelist &moves, int depth,
+                   int alpha, int beta, chess::Move &bestMove);
+
+    uint64_t totalNodes() const;
+
+    // Called once per node, polls the time manager every STOP_CHECK_INTERVAL
+    // nodes and reports whether the search has to stop
+    bool limitReached(SearchThread &thread);
+
+    // True when the search was stopped or a split point above this thread failed high
+    bool shouldStop(const SearchThread &thread) const
+    {
+        return stopRequested.load(std::memory_order_relaxed) ||
+               (thread.splitPoint && thread.splitPoint->aborted());
+    }
+
+    int searchMove(EvalBoard &board, chess::Move move, int moveIndex, int depth, int ply,
+                   int alpha, int beta, SearchThread &thread);
+
+    bool canSplit(int depth) const;
 
-    int quiesence(chess::Board &board, int alpha, int beta, uint64_t &nodes, int ply = 0);
+    void splitSearch(EvalBoard &board, const chess::Movelist &moves, int depth, int ply,
+                     int &alpha, int beta, int &bestScore, chess::Move &bestMove,
+                     SearchThread &thread);
 
-    void orderMoves(chess::Board &board, chess::Movelist &moves);
+    void searchSplitMoves(SplitPoint &sp, EvalBoard &board, SearchThread &thread);
 
-    void scoreMoves(const chess::Board &board, chess::Move &move);
+    void splitWorker(SearchThread &thread);
 
-    int evaluatePosition(const chess::Board &board);
+    // First published split point with moves left, only those below ancestor when given
+    SplitPoint *findSplitPoint(const SplitPoint *ancestor = nullptr) const;
+
+    // allowNull is false right after a null move so two are never played in a row
+    int negamax(EvalBoard &board, int depth, int ply, int alpha, int beta,
+                SearchThread &thread, bool allowNull = true);
+
+    // Non-pawn material for the side to move, null move is unsafe without it (zugzwang)
+    static bool hasNonPawnMaterial(const chess::Board &board);
+
+    int quiesence(EvalBoard &board, int alpha, int beta, SearchThread &thread, int ply = 0, int qsPly = 0);
+
+    // Full generate-score-sort ordering for the root and quiescence, negamax uses MovePicker
+    void orderMoves(chess::Board &board, chess::Movelist &moves,
+                    chess::Move ttMove = chess::Move::NO_MOVE);
+
+    void scoreMoves(const chess::Board &board, chess::Move &move, chess::Move ttMove);
+
+    static bool isQuiet(const chess::Board &board, chess::Move move);
+
+    int evaluatePosition(const EvalBoard &board, SearchThread &thread);
 
     void printSearchInfo(const SearchStats &stats);
 
@@ -79,9 +321,13 @@ private:
 
     std::mt19937 rng;
 
-    std::array<std::array<chess::Move, NUM_MOVES>, NUM_PLIES> searchMoves;
-
     TranspositionTable tt;
+
+    // One pawn hash table and eval cache per search thread
+    std::vector<std::unique_ptr<PawnHashTable>> pawnTables;
+    std::vector<std::unique_ptr<EvalCache>> evalCaches;
+
+    std::vector<std::unique_ptr<SearchThread>> searchThreads;
 };
 
 #endif // CHESS_ENGINE_HPP
\ No newline at end of file
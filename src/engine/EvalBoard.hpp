@@ -0,0 +1,83 @@
+#ifndef EVAL_BOARD_HPP
+#define EVAL_BOARD_HPP
+
+#include "../chess.hpp"
+#include "Evaluation.hpp"
+
+// Board that keeps the material + piece-square sums, the game phase and a
+// pawn-only zobrist key up to date as pieces are placed and removed, so
+// Evaluation only has to compute the non-linear terms at every node.
+class EvalBoard : public chess::Board
+{
+public:
+    explicit EvalBoard(const std::string &fen = chess::STARTPOS) : chess::Board(fen) { refresh(); }
+
+    explicit EvalBoard(const chess::Board &board) : chess::Board(board) { refresh(); }
+
+    void setFen(const std::string &fen) override
+    {
+        chess::Board::setFen(fen);
+        refresh();
+    }
+
+    int midgame() const { return mid_; }
+    int endgame() const { return end_; }
+    int phase() const { return phase_; }
+    uint64_t pawnKey() const { return pawnKey_; }
+
+protected:
+    void placePiece(chess::Piece piece, chess::Square sq) override
+    {
+        chess::Board::placePiece(piece, sq);
+        const auto &value = Evaluation::PSQT[static_cast<int>(piece)][sq];
+        mid_ += value[0];
+        end_ += value[1];
+        phase_ += Evaluation::PHASE_WEIGHT[static_cast<int>(piece)];
+        if (isPawn(piece))
+            pawnKey_ ^= chess::zobrist::piece(piece, sq);
+    }
+
+    void removePiece(chess::Piece piece, chess::Square sq) override
+    {
+        chess::Board::removePiece(piece, sq);
+        const auto &value = Evaluation::PSQT[static_cast<int>(piece)][sq];
+        mid_ -= value[0];
+        end_ -= value[1];
+        phase_ -= Evaluation::PHASE_WEIGHT[static_cast<int>(piece)];
+        if (isPawn(piece))
+            pawnKey_ ^= chess::zobrist::piece(piece, sq);
+    }
+
+private:
+    int mid_ = 0;
+    int end_ = 0;
+    int phase_ = 0;
+    uint64_t pawnKey_ = 0;
+
+    static bool isPawn(chess::Piece piece)
+    {
+        return piece == chess::Piece::WHITEPAWN || piece == chess::Piece::BLACKPAWN;
+    }
+
+    // Recompute the accumulators from scratch: the base class constructor places
+    // pieces before our overrides are active and setFen() never removes the old ones
+    void refresh()
+    {
+        mid_ = end_ = phase_ = 0;
+        pawnKey_ = 0;
+        const auto &table = Evaluation::PSQT;
+        auto pieces = occ();
+        while (pieces)
+        {
+            auto sq = chess::builtin::poplsb(pieces);
+            int piece = static_cast<int>(at(sq));
+            mid_ += table[piece][sq][0];
+            end_ += table[piece][sq][1];
+            phase_ += Evaluation::PHASE_WEIGHT[piece];
+            if (isPawn(at(sq)))
+                pawnKey_ ^= chess::zobrist::piece(at(sq), sq);
+        }
+    }
+};
+
+#endif // EVAL_BOARD_HPP
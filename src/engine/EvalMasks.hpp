@@ -0,0 +1,109 @@
+#ifndef EVAL_MASKS_HPP
+#define EVAL_MASKS_HPP
+
+#include "../chess.hpp"
+#include <array>
+
+// Square masks used by the evaluation, all generated at compile time.
+// Squares are numbered A1 = 0 ... H8 = 63, colour index 0 is white.
+namespace EvalMasks
+{
+    using SquareMasks = std::array<chess::Bitboard, 64>;
+    using ColorMasks = std::array<SquareMasks, 2>;
+
+    constexpr chess::Bitboard RANK_1 = 0xFFULL;
+
+    constexpr std::array<chess::Bitboard, 8> FILE_MASKS = []()
+    {
+        std::array<chess::Bitboard, 8> masks{};
+        for (int file = 0; file < 8; file++)
+            for (int rank = 0; rank < 8; rank++)
+                masks[file] |= 1ULL << (rank * 8 + file);
+        return masks;
+    }();
+
+    // Files next to the square's file, no own pawn there means the pawn is isolated
+    constexpr SquareMasks ADJACENT_FILES = []()
+    {
+        SquareMasks masks{};
+        for (int sq = 0; sq < 64; sq++)
+        {
+            int file = sq % 8;
+            if (file > 0)
+                masks[sq] |= FILE_MASKS[file - 1];
+            if (file < 7)
+                masks[sq] |= FILE_MASKS[file + 1];
+        }
+        return masks;
+    }();
+
+    // Squares in front of the square on its own file, seen from each side
+    constexpr ColorMasks FORWARD_SPAN = []()
+    {
+        ColorMasks masks{};
+        for (int sq = 0; sq < 64; sq++)
+        {
+            int file = sq % 8;
+            int rank = sq / 8;
+            for (int r = rank + 1; r < 8; r++)
+                masks[0][sq] |= 1ULL << (r * 8 + file);
+            for (int r = rank - 1; r >= 0; r--)
+                masks[1][sq] |= 1ULL << (r * 8 + file);
+        }
+        return masks;
+    }();
+
+    // Squares in front of the square on the adjacent files, i.e. every square
+    // an enemy pawn could attack it from
+    constexpr ColorMasks PAWN_ATTACK_SPAN = []()
+    {
+        ColorMasks masks{};
+        for (int color = 0; color < 2; color++)
+        {
+            for (int sq = 0; sq < 64; sq++)
+            {
+                int file = sq % 8;
+                if (file > 0)
+                    masks[color][sq] |= FORWARD_SPAN[color][sq - 1];
+                if (file < 7)
+                    masks[color][sq] |= FORWARD_SPAN[color][sq + 1];
+            }
+        }
+        return masks;
+    }();
+
+    // No enemy pawn in front on this or an adjacent file
+    constexpr ColorMasks PASSED = []()
+    {
+        ColorMasks masks{};
+        for (int color = 0; color < 2; color++)
+            for (int sq = 0; sq < 64; sq++)
+                masks[color][sq] = FORWARD_SPAN[color][sq] | PAWN_ATTACK_SPAN[color][sq];
+        return masks;
+    }();
+
+    // King square plus every square it touches
+    constexpr SquareMasks KING_ZONE = []()
+    {
+        SquareMasks masks{};
+        for (int sq = 0; sq < 64; sq++)
+        {
+            int file = sq % 8;
+            int rank = sq / 8;
+            for (int r = rank - 1; r <= rank + 1; r++)
+                for (int f = file - 1; f <= file + 1; f++)
+                    if (r >= 0 && r < 8 && f >= 0 && f < 8)
+                        masks[sq] |= 1ULL << (r * 8 + f);
+        }
+        return masks;
+    }();
+
+    // Ranks 4 to 6 from each side's point of view, a square there is an outpost
+    // when PAWN_ATTACK_SPAN[side][sq] holds no enemy pawn
+    constexpr std::array<chess::Bitboard, 2> OUTPOST_RANKS = {
+        (RANK_1 << 24) | (RANK_1 << 32) | (RANK_1 << 40),
+        (RANK_1 << 16) | (RANK_1 << 24) | (RANK_1 << 32),
+    };
+} // namespace EvalMasks
+
+#endif // EVAL_MASKS_HPP
@@ -0,0 +1,37 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. The pages are shared with every
+// other process mapping the same file and are loaded by the OS on demand.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string &path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // Map the file, false if it cannot be opened. An empty file maps to size 0.
+    bool open(const std::string &path);
+    void close();
+
+    bool isOpen() const { return opened; }
+    const char *data() const { return begin; }
+    size_t size() const { return length; }
+
+private:
+    const char *begin = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+};
+
+#endif // MAPPED_FILE_HPP
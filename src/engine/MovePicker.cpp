@@ -0,0 +1,172 @@
+#include "MovePicker.hpp"
+#include "See.hpp"
+#include <limits>
+
+namespace
+{
+    // MVV-LVA scores from here on are captures of an equal or more valuable piece
+    constexpr int EQUAL_TRADE_SCORE = 6000;
+    // Taken moves are overwritten with NO_MOVE and sink to the end of their list
+    constexpr int TAKEN_SCORE = std::numeric_limits<int16_t>::min();
+}
+
+MovePicker::MovePicker(const chess::Board &board, chess::Move ttMove, const SearchHeuristics &heuristics, int ply)
+    : board(board), heuristics(heuristics), ttMove(ttMove)
+{
+    refutations[0] = heuristics.killer(ply, 0);
+    refutations[1] = heuristics.killer(ply, 1);
+    refutations[2] = heuristics.counterMove(board, ply);
+}
+
+chess::Move MovePicker::next()
+{
+    while (true)
+    {
+        switch (stage)
+        {
+        case Stage::TT_MOVE:
+            stage = Stage::GENERATE_CAPTURES;
+            if (ttMove != chess::Move::NO_MOVE && ttMove != chess::Move::NULL_MOVE)
+            {
+                // The TT move may come from a key collision, it is only played if
+                // the generator for its kind of move produces it as well
+                bool capture = isCaptureMove(ttMove);
+                if (capture)
+                    generateCaptures();
+                else
+                    generateQuiets();
+                if (take(capture ? captures : quiets, ttMove))
+                    return ttMove;
+            }
+            break;
+
+        case Stage::GENERATE_CAPTURES:
+            if (!capturesGenerated)
+                generateCaptures();
+            index = 0;
+            stage = Stage::GOOD_CAPTURES;
+            break;
+
+        case Stage::GOOD_CAPTURES:
+            while (index < captures.size())
+            {
+                chess::Move move = selectBest(captures, index++);
+                if (move == chess::Move::NO_MOVE)
+                    continue;
+                // SEE only runs for captures that are picked and might lose material
+                if (move.score() >= EQUAL_TRADE_SCORE || SEE::isGoodCapture(move, board, 0))
+                    return move;
+                // Slots before index were already handed out, so they can hold the rejects
+                captures[badCaptures++] = move;
+            }
+            stage = Stage::GENERATE_QUIETS;
+            break;
+
+        case Stage::GENERATE_QUIETS:
+            if (!quietsGenerated)
+                generateQuiets();
+            index = 0;
+            stage = Stage::KILLERS;
+            break;
+
+        case Stage::KILLERS:
+            while (index < NUM_REFUTATIONS)
+            {
+                chess::Move move = refutations[index++];
+                if (move != chess::Move::NO_MOVE && take(quiets, move))
+                    return move;
+            }
+            for (auto &move : quiets)
+            {
+                if (move == chess::Move::NO_MOVE)
+                    move.setScore(TAKEN_SCORE);
+                else if (move.typeOf() == chess::Move::PROMOTION)
+                    move.setScore(move.promotionType() == chess::PieceType::QUEEN ? QUIET_QUEEN_PROMOTION_SCORE
+                                                                                   : UNDER_PROMOTION_SCORE);
+                else
+                    move.setScore(heuristics.historyScore(board, move));
+            }
+            index = 0;
+            stage = Stage::QUIETS;
+            break;
+
+        case Stage::QUIETS:
+            while (index < quiets.size())
+            {
+                chess::Move move = selectBest(quiets, index++);
+                if (move != chess::Move::NO_MOVE)
+                    return move;
+            }
+            index = 0;
+            stage = Stage::BAD_CAPTURES;
+            break;
+
+        case Stage::BAD_CAPTURES:
+            if (index < badCaptures)
+                return captures[index++];
+            stage = Stage::DONE;
+            break;
+
+        case Stage::DONE:
+            return chess::Move::NO_MOVE;
+        }
+    }
+}
+
+void MovePicker::generateCaptures()
+{
+    chess::movegen::legalmoves<chess::MoveGenType::CAPTURE>(captures, board);
+    capturesGenerated = true;
+
+    for (auto &move : captures)
+    {
+        chess::PieceType victim = move.typeOf() == chess::Move::ENPASSANT
+                                      ? chess::PieceType::PAWN
+                                      : chess::utils::typeOfPiece(board.at(move.to()));
+        chess::PieceType attacker = chess::utils::typeOfPiece(board.at(move.from()));
+        int score = SEE::getMvvLvaScore(victim, attacker);
+        if (move.typeOf() == chess::Move::PROMOTION)
+        {
+            // Capturing under-promotions are only worth trying last
+            score = move.promotionType() == chess::PieceType::QUEEN ? score + PROMOTION_BONUS : 0;
+        }
+        move.setScore(score);
+    }
+}
+
+void MovePicker::generateQuiets()
+{
+    chess::movegen::legalmoves<chess::MoveGenType::QUIET>(quiets, board);
+    quietsGenerated = true;
+}
+
+chess::Move MovePicker::selectBest(chess::Movelist &list, int index)
+{
+    int best = index;
+    for (int i = index + 1; i < list.size(); i++)
+    {
+        if (list[i].score() > list[best].score())
+            best = i;
+    }
+    std::swap(list[index], list[best]);
+    return list[index];
+}
+
+bool MovePicker::take(chess::Movelist &list, chess::Move move)
+{
+    int i = list.find(move);
+    if (i < 0)
+        return false;
+    list[i] = chess::Move::NO_MOVE;
+    list[i].setScore(TAKEN_SCORE);
+    return true;
+}
+
+bool MovePicker::isCaptureMove(chess::Move move) const
+{
+    if (move.typeOf() == chess::Move::ENPASSANT)
+        return true;
+    if (move.typeOf() == chess::Move::CASTLING)
+        return false;
+    return board.at(move.to()) != chess::Piece::NONE;
+}
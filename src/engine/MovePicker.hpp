@@ -0,0 +1,66 @@
+#ifndef MOVE_PICKER_HPP
+#define MOVE_PICKER_HPP
+
+#include "../chess.hpp"
+#include "SearchHeuristics.hpp"
+
+// Hands out the legal moves of a position one at a time, best first, doing
+// only as much generation, scoring and SEE work as the moves actually taken
+// need. Stages:
+//   TT move -> good captures -> killers/countermove -> quiets by history -> bad captures
+class MovePicker
+{
+public:
+    MovePicker(const chess::Board &board, chess::Move ttMove, const SearchHeuristics &heuristics, int ply);
+
+    // Next move to search, NO_MOVE once every legal move was returned
+    chess::Move next();
+
+private:
+    enum class Stage
+    {
+        TT_MOVE,
+        GENERATE_CAPTURES,
+        GOOD_CAPTURES,
+        GENERATE_QUIETS,
+        KILLERS,
+        QUIETS,
+        BAD_CAPTURES,
+        DONE
+    };
+
+    static constexpr int NUM_REFUTATIONS = 3; // two killers and the countermove
+
+    static constexpr int PROMOTION_BONUS = 2000; // queen promotions among captures
+    static constexpr int QUIET_QUEEN_PROMOTION_SCORE = SearchHeuristics::HISTORY_MAX + 1;
+    static constexpr int UNDER_PROMOTION_SCORE = -SearchHeuristics::HISTORY_MAX - 1;
+
+    const chess::Board &board;
+    const SearchHeuristics &heuristics;
+    Stage stage = Stage::TT_MOVE;
+    chess::Move ttMove;
+
+    chess::Movelist captures; // losing captures are moved to the front once rejected
+    chess::Movelist quiets;
+    chess::Move refutations[NUM_REFUTATIONS];
+    int index = 0;
+    int badCaptures = 0;
+
+    bool capturesGenerated = false;
+    bool quietsGenerated = false;
+
+    void generateCaptures();
+    void generateQuiets();
+
+    // Move the highest scored move of list[index..] to index and return it
+    static chess::Move selectBest(chess::Movelist &list, int index);
+
+    // Remove move from list if present, returns whether it was found
+    static bool take(chess::Movelist &list, chess::Move move);
+
+    // True when the move comes from the CAPTURE generator (captures, capture
+    // promotions and en passant), castling is encoded as king takes rook
+    bool isCaptureMove(chess::Move move) const;
+};
+
+#endif // MOVE_PICKER_HPP
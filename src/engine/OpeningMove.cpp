@@ -1,9 +1,8 @@
 #include "OpeningMove.hpp"
+#include "MappedFile.hpp"
 #include <fstream>
-#include <sstream>
 #include <iostream>
 #include <filesystem>
-#include <regex>
 #include <random>
 #include <algorithm>
 
@@ -59,6 +58,7 @@ bool OpeningMove::initializeFromFile(const std::string &pgnFilePath)
 {
     // Clear any existing opening book data
     openingBook->positions.clear();
+    compiledBook.close();
 
     // Check if file exists
     std::ifstream fileCheck(pgnFilePath);
@@ -69,6 +69,11 @@ bool OpeningMove::initializeFromFile(const std::string &pgnFilePath)
     }
     fileCheck.close();
 
+    if (std::filesystem::path(pgnFilePath).extension() == ".bin")
+    {
+        return openCompiledBook(pgnFilePath);
+    }
+
     std::cout << "Loading opening book from specific file: " << pgnFilePath << std::endl;
     bool success = parsePgnFile(pgnFilePath);
 
@@ -81,92 +86,61 @@ bool OpeningMove::initializeFromFile(const std::string &pgnFilePath)
     return success;
 }
 
-bool OpeningMove::parsePgnFile(const std::string &filepath)
+bool OpeningMove::openCompiledBook(const std::string &binFilePath)
 {
-    std::ifstream file(filepath);
-    if (!file.is_open())
+    if (!compiledBook.open(binFilePath))
     {
-        std::cerr << "Failed to open PGN file: " << filepath << std::endl;
+        std::cerr << "Failed to open compiled book: " << binFilePath << std::endl;
         return false;
     }
 
-    std::string line;
-    std::string moveText;
-    bool inMoveText = false;
+    std::cout << "Opening book mapped from " << binFilePath << " with entries: "
+              << compiledBook.size() << std::endl;
+    return true;
+}
 
-    while (std::getline(file, line))
+bool OpeningMove::parsePgnFile(const std::string &filepath)
+{
+    MappedFile file;
+    if (!file.open(filepath))
     {
-        // Skip header lines or empty lines
-        if (line.empty() || line[0] == '[')
-        {
-            if (inMoveText && !moveText.empty())
-            {
-                // Process the previous game
-                addGameToBook(moveText);
-                moveText.clear();
-                inMoveText = false;
-            }
-            continue;
-        }
-
-        // We're in the move text section
-        inMoveText = true;
-        moveText += line + " ";
-
-        // If line ends with game result, we've reached the end of a game
-        if (line.find("1-0") != std::string::npos ||
-            line.find("0-1") != std::string::npos ||
-            line.find("1/2-1/2") != std::string::npos ||
-            line.find("*") != std::string::npos)
-        {
-
-            addGameToBook(moveText);
-            moveText.clear();
-            inMoveText = false;
-        }
+        std::cerr << "Failed to open PGN file: " << filepath << std::endl;
+        return false;
     }
 
-    // Process the last game if it wasn't processed
-    if (inMoveText && !moveText.empty())
+    PgnTokenizer tokenizer(file.data(), file.data() + file.size());
+    while (!tokenizer.done())
     {
-        addGameToBook(moveText);
+        addGameToBook(tokenizer);
     }
 
     return true;
 }
 
-void OpeningMove::addGameToBook(const std::string &moveText)
+void OpeningMove::addGameToBook(PgnTokenizer &tokenizer)
 {
-    // Regular expression to extract moves from PGN format
-    std::regex movePattern(R"(([a-zA-Z0-9][a-zA-Z0-9\+\#\=\-]+)[\s\.\[\]\(\)\{\}]*)");
-
-    // Setup initial board
-    chess::Board board;
-
-    // Extract moves
-    std::sregex_iterator iter(moveText.begin(), moveText.end(), movePattern);
-    std::sregex_iterator end;
-
+    // Copying the start position is much cheaper than parsing its FEN for every game
+    static const chess::Board startBoard;
+    chess::Board board = startBoard;
     int moveCount = 0;
 
-    while (iter != end && moveCount < maxBookMoves)
+    std::string_view san;
+    while (tokenizer.next(san) == PgnTokenizer::Token::MOVE)
     {
-        std::string moveStr = (*iter)[1];
-
-        // Skip move numbers, annotations and game results
-        if (std::isdigit(moveStr[0]) || moveStr == "1-0" || moveStr == "0-1" || moveStr == "1/2-1/2" || moveStr == "*")
+        if (moveCount >= maxBookMoves)
         {
-            ++iter;
-            continue;
+            // Past the book depth, only the end of the game is of interest
+            tokenizer.skipGame();
+            return;
         }
 
-        // Convert algebraic notation to Move
-        chess::Move move = algebraicToMove(board, moveStr);
+        chess::Move move = PgnTokenizer::sanToMove(board, san);
         if (move == chess::Move::NULL_MOVE)
         {
             // Failed to parse move, skip to next game
-            std::cerr << "Failed to parse move: " << moveStr << std::endl;
-            break;
+            std::cerr << "Failed to parse move: " << san << std::endl;
+            tokenizer.skipGame();
+            return;
         }
 
         // Store the move in the opening book
@@ -192,23 +166,54 @@ void OpeningMove::addGameToBook(const std::string &moveText)
         // Make the move and continue
         board.makeMove(move);
         moveCount++;
-        ++iter;
     }
 }
 
-chess::Move OpeningMove::getBookMove(const chess::Board &board)
+chess::Move OpeningMove::getBookMove(const chess::Board &board) const
 {
-    // Get position hash
-    uint64_t hash = board.hash();
+    if (compiledBook.isOpen())
+    {
+        return chooseMove(getCompiledBookMoves(board));
+    }
 
     // Check if position is in opening book
-    auto it = openingBook->positions.find(hash);
+    auto it = openingBook->positions.find(board.hash());
     if (it == openingBook->positions.end())
     {
         return chess::Move::NULL_MOVE;
     }
 
-    const auto &moves = it->second;
+    return chooseMove(it->second);
+}
+
+chess::Move OpeningMove::chooseMove(const std::vector<std::pair<chess::Move, int>> &moves) const
+{
+    if (selection == Selection::WEIGHTED_RANDOM)
+    {
+        int totalWeight = 0;
+        for (const auto &[move, weight] : moves)
+        {
+            totalWeight += weight;
+        }
+        if (totalWeight <= 0)
+        {
+            return chess::Move::NULL_MOVE;
+        }
+
+        // The book is shared between engine threads, each draws from its own generator
+        thread_local std::mt19937 rng(std::random_device{}());
+        int pick = std::uniform_int_distribution<int>(0, totalWeight - 1)(rng);
+        for (const auto &[move, weight] : moves)
+        {
+            if (pick < weight)
+            {
+                std::cout << "Using random opening move (weight: " << weight << " of " << totalWeight << ")" << std::endl;
+                return move;
+            }
+            pick -= weight;
+        }
+        return chess::Move::NULL_MOVE;
+    }
 
     // Find the move with the highest weight (most frequent appearance)
     chess::Move bestMove = chess::Move::NULL_MOVE;
@@ -231,185 +236,40 @@ chess::Move OpeningMove::getBookMove(const chess::Board &board)
     return bestMove;
 }
 
-chess::Move OpeningMove::algebraicToMove(const chess::Board &board, const std::string &moveStr)
+std::vector<std::pair<chess::Move, int>> OpeningMove::getCompiledBookMoves(const chess::Board &board) const
 {
-    // Generate all legal moves
-    chess::Movelist moves;
-    chess::movegen::legalmoves(moves, board);
-
-    // Check if the move is castling
-    if (moveStr == "O-O" || moveStr == "0-0")
+    std::vector<std::pair<chess::Move, int>> moves;
+
+    // The PGN book only holds the first maxBookMoves plies of each game, a
+    // compiled one can be deeper. chess.hpp stores twice the FEN full move
+    // number and adds one per ply made, so it counts plies from 2 only when the
+    // FEN had white to move. Otherwise the counter and the side to move differ
+    // in parity and the missing ply is added back.
+    int counter = board.fullMoveNumber();
+    bool blackToMove = board.sideToMove() == chess::Color::BLACK;
+    int ply = counter - 2 + ((counter + blackToMove) & 1);
+    if (ply >= maxBookMoves)
     {
-        // Kingside castling
-        for (const auto &move : moves)
-        {
-            if (move.typeOf() == chess::Move::CASTLING &&
-                chess::utils::squareFile(move.to()) > chess::utils::squareFile(move.from()))
-            {
-                return move;
-            }
-        }
+        return moves;
     }
-    else if (moveStr == "O-O-O" || moveStr == "0-0-0")
+
+    std::vector<PolyglotEntry> entries = compiledBook.probe(board.hash());
+    if (entries.empty())
     {
-        // Queenside castling
-        for (const auto &move : moves)
-        {
-            if (move.typeOf() == chess::Move::CASTLING &&
-                chess::utils::squareFile(move.to()) < chess::utils::squareFile(move.from()))
-            {
-                return move;
-            }
-        }
+        return moves;
     }
-    else
-    {
-        // Handle regular moves
-        std::string sanitized = moveStr;
-        // Remove check/mate symbols and captures
-        sanitized.erase(std::remove_if(sanitized.begin(), sanitized.end(),
-                                       [](char c)
-                                       { return c == '+' || c == '#' || c == 'x'; }),
-                        sanitized.end());
-
-        char targetPiece = 'P'; // Default to pawn
-        if (std::isupper(sanitized[0]))
-        {
-            targetPiece = sanitized[0];
-            sanitized = sanitized.substr(1);
-        }
-
-        // Handle pawn promotion
-        chess::PieceType promotionType = chess::PieceType::NONE;
-        size_t equalPos = sanitized.find('=');
-        if (equalPos != std::string::npos)
-        {
-            char promotionChar = sanitized[equalPos + 1];
-            switch (promotionChar)
-            {
-            case 'Q':
-                promotionType = chess::PieceType::QUEEN;
-                break;
-            case 'R':
-                promotionType = chess::PieceType::ROOK;
-                break;
-            case 'B':
-                promotionType = chess::PieceType::BISHOP;
-                break;
-            case 'N':
-                promotionType = chess::PieceType::KNIGHT;
-                break;
-            default:
-                break;
-            }
-            sanitized = sanitized.substr(0, equalPos);
-        }
-
-        // Extract destination square
-        std::string destSquare;
-        if (sanitized.size() >= 2)
-        {
-            destSquare = sanitized.substr(sanitized.size() - 2);
-            sanitized = sanitized.substr(0, sanitized.size() - 2);
-        }
-
-        // Convert destination to square index
-        int destFile = destSquare[0] - 'a';
-        int destRank = destSquare[1] - '1';
 
-        if (destFile < 0 || destFile > 7 || destRank < 0 || destRank > 7)
-        {
-            return chess::Move::NULL_MOVE;
-        }
-
-        chess::Square destSq = chess::Square(destRank * 8 + destFile);
-
-        // Extract disambiguation (if any)
-        char disambFile = -1;
-        int disambRank = -1;
-
-        if (!sanitized.empty())
-        {
-            for (char c : sanitized)
-            {
-                if (c >= 'a' && c <= 'h')
-                {
-                    disambFile = c - 'a';
-                }
-                else if (c >= '1' && c <= '8')
-                {
-                    disambRank = c - '1';
-                }
-            }
-        }
-
-        // Find the matching move
-        for (const auto &move : moves)
+    chess::Movelist legalMoves;
+    chess::movegen::legalmoves(legalMoves, board);
+    for (const auto &entry : entries)
+    {
+        // Weight 0 marks a move that must not be played. Moves that are not
+        // legal here come from a key collision.
+        chess::Move move = PolyglotBook::decodeMove(legalMoves, entry.move);
+        if (entry.weight > 0 && move != chess::Move::NULL_MOVE)
         {
-            chess::Square fromSq = move.from();
-            chess::Square toSq = move.to();
-            chess::PieceType pieceType = board.at<chess::PieceType>(fromSq);
-
-            // Check if the piece type matches
-            bool pieceMatches = false;
-            switch (targetPiece)
-            {
-            case 'P':
-                pieceMatches = (pieceType == chess::PieceType::PAWN);
-                break;
-            case 'N':
-                pieceMatches = (pieceType == chess::PieceType::KNIGHT);
-                break;
-            case 'B':
-                pieceMatches = (pieceType == chess::PieceType::BISHOP);
-                break;
-            case 'R':
-                pieceMatches = (pieceType == chess::PieceType::ROOK);
-                break;
-            case 'Q':
-                pieceMatches = (pieceType == chess::PieceType::QUEEN);
-                break;
-            case 'K':
-                pieceMatches = (pieceType == chess::PieceType::KING);
-                break;
-            }
-
-            if (!pieceMatches)
-            {
-                continue;
-            }
-
-            // Check destination
-            if (toSq != destSq)
-            {
-                continue;
-            }
-
-            // Check disambiguation
-            if (disambFile != -1 && static_cast<int>(chess::utils::squareFile(fromSq)) != disambFile)
-            {
-                continue;
-            }
-
-            if (disambRank != -1 && static_cast<int>(chess::utils::squareRank(fromSq)) != disambRank)
-            {
-                continue;
-            }
-
-            // Check promotion
-            if (promotionType != chess::PieceType::NONE)
-            {
-                if (move.typeOf() != chess::Move::PROMOTION || move.promotionType() != promotionType)
-                {
-                    continue;
-                }
-            }
-
-            // Found a match!
-            return move;
+            moves.emplace_back(move, entry.weight);
         }
     }
-
-    // No matching move found
-    return chess::Move::NULL_MOVE;
-}
\ No newline at end of file
+    return moves;
+}
@@ -2,6 +2,8 @@
 #define OPENING_MOVE_HPP
 
 #include "../chess.hpp"
+#include "PgnTokenizer.hpp"
+#include "PolyglotBook.hpp"
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -10,21 +12,41 @@
 class OpeningMove
 {
 public:
+    // How getBookMove picks among the moves stored for a position
+    enum class Selection
+    {
+        BEST_WEIGHT,    // always the most frequent move
+        WEIGHTED_RANDOM // any move, with probability proportional to its weight
+    };
+
     OpeningMove();
     ~OpeningMove() = default;
 
     // Initialize opening book from PGN files in assets/opening directory
     bool initialize(const std::string &openingDirPath = "assets/opening");
 
-    // Initialize opening book from a specific PGN file
+    // Initialize opening book from a specific PGN file, or from a compiled
+    // book when the file ends in .bin
     bool initializeFromFile(const std::string &pgnFilePath);
 
-    chess::Move getBookMove(const chess::Board &board);
+    // Add the games of a PGN file to the current book
+    bool addPgnFile(const std::string &pgnFilePath) { return parsePgnFile(pgnFilePath); }
+
+    chess::Move getBookMove(const chess::Board &board) const;
 
     void setMaxBookMoves(int max) { maxBookMoves = max; }
 
     int getMaxBookMoves() const { return maxBookMoves; }
 
+    void setSelection(Selection mode) { selection = mode; }
+
+    Selection getSelection() const { return selection; }
+
+    // Number of distinct positions read from PGN
+    size_t getPositionCount() const { return openingBook->positions.size(); }
+
+    bool isCompiled() const { return compiledBook.isOpen(); }
+
 private:
     struct OpeningNode
     {
@@ -32,16 +54,23 @@ private:
     };
 
     std::unique_ptr<OpeningNode> openingBook;
+    PolyglotBook compiledBook; // used instead of openingBook once opened
     int maxBookMoves = 12; // Default to 12 moves from opening book
+    Selection selection = Selection::BEST_WEIGHT;
 
     // Parse a PGN file and add its moves to the opening book
     bool parsePgnFile(const std::string &filepath);
 
-    // Extract moves from a PGN game and add them to the opening book
-    void addGameToBook(const std::string &moveText);
+    // Open a compiled book, the file is searched in place
+    bool openCompiledBook(const std::string &binFilePath);
+
+    // Legal moves of a compiled book entry with their weights
+    std::vector<std::pair<chess::Move, int>> getCompiledBookMoves(const chess::Board &board) const;
+
+    chess::Move chooseMove(const std::vector<std::pair<chess::Move, int>> &moves) const;
 
-    // Converts algebraic notation (e.g. "e4") to a chess::Move
-    chess::Move algebraicToMove(const chess::Board &board, const std::string &moveStr);
+    // Read the next game from the tokenizer and add its first moves to the opening book
+    void addGameToBook(PgnTokenizer &tokenizer);
 };
 
 #endif // OPENING_MOVE_HPP
\ No newline at end of file
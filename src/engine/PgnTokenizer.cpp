@@ -0,0 +1,349 @@
+#include "PgnTokenizer.hpp"
+
+namespace
+{
+    // Characters that can be part of a SAN move, move number or result
+    bool isWordChar(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               c == '+' || c == '#' || c == '=' || c == '-' || c == '/';
+    }
+
+    // Start of a tag pair, comment or variation, or part of a result
+    bool isGameBreak(char c)
+    {
+        return c == '[' || c == '{' || c == ';' || c == '(' || c == '*' || c == '-';
+    }
+
+    bool isDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    chess::PieceType pieceFromLetter(char c)
+    {
+        switch (c)
+        {
+        case 'N':
+            return chess::PieceType::KNIGHT;
+        case 'B':
+            return chess::PieceType::BISHOP;
+        case 'R':
+            return chess::PieceType::ROOK;
+        case 'Q':
+            return chess::PieceType::QUEEN;
+        case 'K':
+            return chess::PieceType::KING;
+        default:
+            return chess::PieceType::NONE;
+        }
+    }
+}
+
+PgnTokenizer::PgnTokenizer(const char *begin, const char *end)
+    : cursor(begin), last(end)
+{
+}
+
+PgnTokenizer::Token PgnTokenizer::next(std::string_view &san)
+{
+    while (cursor < last)
+    {
+        char c = *cursor;
+
+        if (c == '[')
+        {
+            // Tags of the next game, end the current one first if it had no result
+            if (inGame)
+            {
+                inGame = false;
+                return Token::GAME_END;
+            }
+            skipTagPair();
+            continue;
+        }
+        if (c == '{')
+        {
+            skipComment();
+            continue;
+        }
+        if (c == ';')
+        {
+            skipLine();
+            continue;
+        }
+        if (c == '(')
+        {
+            skipVariation();
+            continue;
+        }
+        if (c == '*')
+        {
+            ++cursor;
+            inGame = false;
+            return Token::GAME_END;
+        }
+        if (!isWordChar(c))
+        {
+            // Whitespace, move number dots, '$' of NAGs, '!' and '?'
+            ++cursor;
+            continue;
+        }
+
+        const char *start = cursor;
+        while (cursor < last && isWordChar(*cursor))
+        {
+            ++cursor;
+        }
+        std::string_view word(start, cursor - start);
+
+        if (word == "1-0" || word == "0-1" || word == "1/2-1/2")
+        {
+            inGame = false;
+            return Token::GAME_END;
+        }
+
+        // Move numbers and NAG values
+        bool number = true;
+        for (char w : word)
+        {
+            number = number && isDigit(w);
+        }
+        if (number)
+        {
+            continue;
+        }
+
+        inGame = true;
+        san = word;
+        return Token::MOVE;
+    }
+
+    if (inGame)
+    {
+        inGame = false;
+        return Token::GAME_END;
+    }
+    return Token::END;
+}
+
+void PgnTokenizer::skipGame()
+{
+    // Jump from one character that could end the game to the next instead of
+    // splitting the move text into tokens, then let next() look at it
+    std::string_view ignored;
+    const char *floor = cursor;
+    while (cursor < last)
+    {
+        const char *stop = cursor;
+        while (stop < last && !isGameBreak(*stop))
+        {
+            ++stop;
+        }
+        // Back up so that next() sees the whole word, e.g. "1/2-1/2" or "O-O"
+        while (stop > floor && isWordChar(stop[-1]))
+        {
+            --stop;
+        }
+        cursor = stop;
+        if (next(ignored) != Token::MOVE)
+        {
+            return;
+        }
+        floor = cursor;
+    }
+}
+
+void PgnTokenizer::skipTagPair()
+{
+    bool quoted = false;
+    for (++cursor; cursor < last; ++cursor)
+    {
+        char c = *cursor;
+        if (quoted)
+        {
+            if (c == '\\' && cursor + 1 < last)
+            {
+                ++cursor;
+            }
+            else if (c == '"')
+            {
+                quoted = false;
+            }
+        }
+        else if (c == '"')
+        {
+            quoted = true;
+        }
+        else if (c == ']')
+        {
+            ++cursor;
+            return;
+        }
+    }
+}
+
+void PgnTokenizer::skipComment()
+{
+    while (cursor < last && *cursor != '}')
+    {
+        ++cursor;
+    }
+    if (cursor < last)
+    {
+        ++cursor;
+    }
+}
+
+void PgnTokenizer::skipLine()
+{
+    while (cursor < last && *cursor != '\n')
+    {
+        ++cursor;
+    }
+}
+
+void PgnTokenizer::skipVariation()
+{
+    // Variations nest and may contain comments with unbalanced parentheses
+    int depth = 0;
+    while (cursor < last)
+    {
+        char c = *cursor;
+        if (c == '{')
+        {
+            skipComment();
+            continue;
+        }
+        if (c == ';')
+        {
+            skipLine();
+            continue;
+        }
+        ++cursor;
+        if (c == '(')
+        {
+            ++depth;
+        }
+        else if (c == ')' && --depth == 0)
+        {
+            return;
+        }
+    }
+}
+
+chess::Move PgnTokenizer::sanToMove(const chess::Board &board, std::string_view san)
+{
+    // Check and mate markers carry no information
+    while (!san.empty() && (san.back() == '+' || san.back() == '#'))
+    {
+        san.remove_suffix(1);
+    }
+    if (san.size() < 2)
+    {
+        return chess::Move::NULL_MOVE;
+    }
+
+    chess::Movelist moves;
+    chess::movegen::legalmoves(moves, board);
+
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0")
+    {
+        // Castling moves are encoded as the king taking its own rook
+        bool kingSide = san.size() == 3;
+        for (const auto &move : moves)
+        {
+            if (move.typeOf() == chess::Move::CASTLING && (move.to() > move.from()) == kingSide)
+            {
+                return move;
+            }
+        }
+        return chess::Move::NULL_MOVE;
+    }
+
+    chess::PieceType piece = pieceFromLetter(san[0]);
+    if (piece == chess::PieceType::NONE)
+    {
+        piece = chess::PieceType::PAWN;
+    }
+    else
+    {
+        san.remove_prefix(1);
+    }
+
+    // "e8=Q", also accept "e8Q"
+    chess::PieceType promotion = chess::PieceType::NONE;
+    if (piece == chess::PieceType::PAWN && san.size() >= 3)
+    {
+        promotion = pieceFromLetter(san.back());
+        if (promotion != chess::PieceType::NONE)
+        {
+            san.remove_suffix(1);
+            if (san.back() == '=')
+            {
+                san.remove_suffix(1);
+            }
+        }
+    }
+
+    if (san.size() < 2)
+    {
+        return chess::Move::NULL_MOVE;
+    }
+    int toFile = san[san.size() - 2] - 'a';
+    int toRank = san[san.size() - 1] - '1';
+    if (toFile < 0 || toFile > 7 || toRank < 0 || toRank > 7)
+    {
+        return chess::Move::NULL_MOVE;
+    }
+    chess::Square to = chess::Square(toRank * 8 + toFile);
+    san.remove_suffix(2);
+
+    // Whatever is left is disambiguation and the capture sign
+    int fromFile = -1;
+    int fromRank = -1;
+    for (char c : san)
+    {
+        if (c >= 'a' && c <= 'h')
+        {
+            fromFile = c - 'a';
+        }
+        else if (c >= '1' && c <= '8')
+        {
+            fromRank = c - '1';
+        }
+    }
+
+    for (const auto &move : moves)
+    {
+        if (move.to() != to || move.typeOf() == chess::Move::CASTLING ||
+            board.at<chess::PieceType>(move.from()) != piece)
+        {
+            continue;
+        }
+        if (fromFile != -1 && static_cast<int>(chess::utils::squareFile(move.from())) != fromFile)
+        {
+            continue;
+        }
+        if (fromRank != -1 && static_cast<int>(chess::utils::squareRank(move.from())) != fromRank)
+        {
+            continue;
+        }
+        if (move.typeOf() == chess::Move::PROMOTION)
+        {
+            // An unmarked promotion is taken to be a queen
+            chess::PieceType wanted = promotion != chess::PieceType::NONE ? promotion : chess::PieceType::QUEEN;
+            if (move.promotionType() != wanted)
+            {
+                continue;
+            }
+        }
+        else if (promotion != chess::PieceType::NONE)
+        {
+            continue;
+        }
+        return move;
+    }
+
+    return chess::Move::NULL_MOVE;
+}
@@ -0,0 +1,46 @@
+#ifndef PGN_TOKENIZER_HPP
+#define PGN_TOKENIZER_HPP
+
+#include "../chess.hpp"
+#include <string_view>
+
+// Splits PGN text into the moves of each game without copying or allocating.
+// Tag pairs, comments, variations, NAGs, annotation glyphs and move numbers
+// are skipped; tokens are views into the caller's buffer, which must outlive
+// the tokenizer.
+class PgnTokenizer
+{
+public:
+    enum class Token
+    {
+        MOVE,     // a SAN move
+        GAME_END, // result token, or a new tag section after a game without one
+        END       // no more input
+    };
+
+    PgnTokenizer(const char *begin, const char *end);
+
+    // Next token, for MOVE the SAN text is stored in san
+    Token next(std::string_view &san);
+
+    // Skip the remaining moves of the current game
+    void skipGame();
+
+    bool done() const { return cursor >= last; }
+
+    // Resolve a SAN move ("Nbd7", "exd5", "e8=Q+", "O-O") against the legal
+    // moves of board, NULL_MOVE if none matches
+    static chess::Move sanToMove(const chess::Board &board, std::string_view san);
+
+private:
+    const char *cursor;
+    const char *last;
+    bool inGame = false; // a move was read since the last game end
+
+    void skipTagPair();
+    void skipComment();
+    void skipLine();
+    void skipVariation();
+};
+
+#endif // PGN_TOKENIZER_HPP
@@ -0,0 +1,169 @@
+#include "PolyglotBook.hpp"
+#include <algorithm>
+#include <fstream>
+
+namespace
+{
+    uint64_t readBigEndian(const unsigned char *bytes, int count)
+    {
+        uint64_t value = 0;
+        for (int i = 0; i < count; i++)
+        {
+            value = (value << 8) | bytes[i];
+        }
+        return value;
+    }
+
+    void writeBigEndian(char *bytes, uint64_t value, int count)
+    {
+        for (int i = count - 1; i >= 0; i--)
+        {
+            bytes[i] = static_cast<char>(value & 0xFF);
+            value >>= 8;
+        }
+    }
+
+    // Polyglot promotion codes: 1 knight, 2 bishop, 3 rook, 4 queen
+    int promotionCode(chess::PieceType type)
+    {
+        switch (type)
+        {
+        case chess::PieceType::KNIGHT:
+            return 1;
+        case chess::PieceType::BISHOP:
+            return 2;
+        case chess::PieceType::ROOK:
+            return 3;
+        case chess::PieceType::QUEEN:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+}
+
+bool PolyglotBook::open(const std::string &path)
+{
+    entryCount = 0;
+    if (!file.open(path))
+    {
+        return false;
+    }
+    // A truncated last record is ignored
+    entryCount = file.size() / ENTRY_SIZE;
+    return true;
+}
+
+void PolyglotBook::close()
+{
+    file.close();
+    entryCount = 0;
+}
+
+PolyglotEntry PolyglotBook::entry(size_t index) const
+{
+    const auto *bytes = reinterpret_cast<const unsigned char *>(file.data()) + index * ENTRY_SIZE;
+    PolyglotEntry result;
+    result.key = readBigEndian(bytes, 8);
+    result.move = static_cast<uint16_t>(readBigEndian(bytes + 8, 2));
+    result.weight = static_cast<uint16_t>(readBigEndian(bytes + 10, 2));
+    result.learn = static_cast<uint32_t>(readBigEndian(bytes + 12, 4));
+    return result;
+}
+
+uint64_t PolyglotBook::keyAt(size_t index) const
+{
+    return readBigEndian(reinterpret_cast<const unsigned char *>(file.data()) + index * ENTRY_SIZE, 8);
+}
+
+std::vector<PolyglotEntry> PolyglotBook::probe(uint64_t key) const
+{
+    // Lower bound of key
+    size_t low = 0;
+    size_t high = entryCount;
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (keyAt(middle) < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    std::vector<PolyglotEntry> entries;
+    for (size_t i = low; i < entryCount && keyAt(i) == key; i++)
+    {
+        entries.push_back(entry(i));
+    }
+    return entries;
+}
+
+uint16_t PolyglotBook::encodeMove(chess::Move move)
+{
+    int from = static_cast<int>(move.from());
+    int to = static_cast<int>(move.to());
+    int promotion = move.typeOf() == chess::Move::PROMOTION ? promotionCode(move.promotionType()) : 0;
+    // Square index is rank * 8 + file, which is exactly the two 3-bit fields
+    return static_cast<uint16_t>(to | (from << 6) | (promotion << 12));
+}
+
+chess::Move PolyglotBook::decodeMove(const chess::Board &board, uint16_t move)
+{
+    chess::Movelist moves;
+    chess::movegen::legalmoves(moves, board);
+    return decodeMove(moves, move);
+}
+
+chess::Move PolyglotBook::decodeMove(const chess::Movelist &legalMoves, uint16_t move)
+{
+    for (const auto &legal : legalMoves)
+    {
+        if (encodeMove(legal) == move)
+        {
+            return legal;
+        }
+        // Some book writers store castling as the king's two-square step
+        if (legal.typeOf() == chess::Move::CASTLING)
+        {
+            int from = static_cast<int>(legal.from());
+            int kingTo = legal.to() > legal.from() ? from + 2 : from - 2;
+            if (static_cast<uint16_t>(kingTo | (from << 6)) == move)
+            {
+                return legal;
+            }
+        }
+    }
+    return chess::Move::NULL_MOVE;
+}
+
+bool PolyglotBook::write(const std::string &path, std::vector<PolyglotEntry> entries)
+{
+    // Heaviest move first within a position, the order other Polyglot tools
+    // expect. Equal weights keep the caller's order.
+    std::stable_sort(entries.begin(), entries.end(), [](const PolyglotEntry &a, const PolyglotEntry &b)
+                     {
+        if (a.key != b.key)
+            return a.key < b.key;
+        return a.weight > b.weight; });
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        return false;
+    }
+
+    char record[ENTRY_SIZE];
+    for (const auto &entry : entries)
+    {
+        writeBigEndian(record, entry.key, 8);
+        writeBigEndian(record + 8, entry.move, 2);
+        writeBigEndian(record + 10, entry.weight, 2);
+        writeBigEndian(record + 12, entry.learn, 4);
+        out.write(record, ENTRY_SIZE);
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,58 @@
+#ifndef POLYGLOT_BOOK_HPP
+#define POLYGLOT_BOOK_HPP
+
+#include "../chess.hpp"
+#include "MappedFile.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One record of a Polyglot book. On disk it is 16 bytes, big-endian.
+struct PolyglotEntry
+{
+    uint64_t key = 0;    // Polyglot zobrist key, the same as chess::Board::hash()
+    uint16_t move = 0;   // to file, to rank, from file, from rank and promotion, 3 bits each
+    uint16_t weight = 0; // relative frequency of the move
+    uint32_t learn = 0;  // unused by the engine, kept for other tools
+};
+
+// Read-only Polyglot .bin book. The file is memory-mapped and searched in
+// place: entries are sorted by key, so the moves of a position are adjacent
+// and found with a binary search. Nothing is parsed or copied at load time.
+class PolyglotBook
+{
+public:
+    static constexpr size_t ENTRY_SIZE = 16;
+
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+
+    // Number of entries in the file
+    size_t size() const { return entryCount; }
+
+    // All entries stored for a position, in file order
+    std::vector<PolyglotEntry> probe(uint64_t key) const;
+
+    // Polyglot encodes castling as the king moving onto its rook, like chess::Move
+    static uint16_t encodeMove(chess::Move move);
+
+    // Matches a Polyglot move against the legal moves of board, NULL_MOVE if
+    // it is not legal there (e.g. after a key collision)
+    static chess::Move decodeMove(const chess::Board &board, uint16_t move);
+
+    // Same against legal moves already generated for the position
+    static chess::Move decodeMove(const chess::Movelist &legalMoves, uint16_t move);
+
+    // Sort entries by key and weight and write them as a Polyglot book
+    static bool write(const std::string &path, std::vector<PolyglotEntry> entries);
+
+private:
+    MappedFile file;
+    size_t entryCount = 0;
+
+    PolyglotEntry entry(size_t index) const;
+    uint64_t keyAt(size_t index) const;
+};
+
+#endif // POLYGLOT_BOOK_HPP
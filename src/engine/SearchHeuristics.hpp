@@ -0,0 +1,100 @@
+#ifndef SEARCH_HEURISTICS_HPP
+#define SEARCH_HEURISTICS_HPP
+
+#include "../chess.hpp"
+#include <array>
+#include <cstdlib>
+
+// Quiet move ordering state learned during one search: killer moves per ply,
+// a butterfly history table and countermoves. Each search thread owns one.
+class SearchHeuristics
+{
+public:
+    static constexpr int MAX_PLY = 128;
+
+    // History scores stay within +-HISTORY_MAX
+    static constexpr int HISTORY_MAX = 3000;
+
+    // Remember the move played at ply so the child can look up its countermove
+    void setCurrentMove(int ply, chess::Move move)
+    {
+        if (ply < MAX_PLY)
+            currentMoves[ply] = move;
+    }
+
+    chess::Move killer(int ply, int slot) const
+    {
+        return ply < MAX_PLY ? killers[ply][slot] : chess::Move::NO_MOVE;
+    }
+
+    // Reply that last refuted the previous move, NO_MOVE if there is none
+    chess::Move counterMove(const chess::Board &board, int ply) const
+    {
+        chess::Move previous = ply > 0 && ply <= MAX_PLY ? currentMoves[ply - 1] : chess::Move::NO_MOVE;
+        int piece = previousPiece(board, previous);
+        return piece >= 0 ? counterMoves[piece][previous.to()] : chess::Move::NO_MOVE;
+    }
+
+    int historyScore(const chess::Board &board, chess::Move move) const
+    {
+        return history[colorIndex(board)][move.from()][move.to()];
+    }
+
+    // A quiet move caused a beta cutoff: reward it and punish the quiet moves
+    // searched before it at this node
+    void updateQuiet(const chess::Board &board, chess::Move move, int depth, int ply,
+                     const chess::Movelist &quietsTried)
+    {
+        int bonus = std::min(16 * depth * depth, HISTORY_MAX / 2);
+        auto &table = history[colorIndex(board)];
+        updateHistory(table[move.from()][move.to()], bonus);
+        for (const auto &quiet : quietsTried)
+        {
+            if (quiet != move)
+                updateHistory(table[quiet.from()][quiet.to()], -bonus);
+        }
+
+        if (ply >= MAX_PLY)
+            return;
+
+        if (killers[ply][0] != move)
+        {
+            killers[ply][1] = killers[ply][0];
+            killers[ply][0] = move;
+        }
+
+        chess::Move previous = ply > 0 ? currentMoves[ply - 1] : chess::Move::NO_MOVE;
+        int piece = previousPiece(board, previous);
+        if (piece >= 0)
+            counterMoves[piece][previous.to()] = move;
+    }
+
+private:
+    std::array<std::array<chess::Move, 2>, MAX_PLY> killers{};
+    std::array<chess::Move, MAX_PLY> currentMoves{};
+    std::array<std::array<std::array<int16_t, 64>, 64>, 2> history{};  // [color][from][to]
+    std::array<std::array<chess::Move, 64>, 12> counterMoves{};         // [piece][to] of the previous move
+
+    static int colorIndex(const chess::Board &board)
+    {
+        return board.sideToMove() == chess::Color::WHITE ? 0 : 1;
+    }
+
+    // Gravity update: the closer an entry gets to HISTORY_MAX the smaller the step
+    static void updateHistory(int16_t &entry, int bonus)
+    {
+        entry += bonus - entry * std::abs(bonus) / HISTORY_MAX;
+    }
+
+    // Piece that made the previous move, -1 after a null move or at the root
+    static int previousPiece(const chess::Board &board, chess::Move previous)
+    {
+        if (previous == chess::Move::NO_MOVE || previous == chess::Move::NULL_MOVE ||
+            previous.typeOf() == chess::Move::CASTLING)
+            return -1;
+        chess::Piece piece = board.at(previous.to());
+        return piece == chess::Piece::NONE ? -1 : static_cast<int>(piece);
+    }
+};
+
+#endif // SEARCH_HEURISTICS_HPP
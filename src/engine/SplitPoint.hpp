@@ -0,0 +1,84 @@
+#ifndef SPLIT_POINT_HPP
+#define SPLIT_POINT_HPP
+
+#include "../chess.hpp"
+#include "EvalBoard.hpp"
+#include <atomic>
+#include <mutex>
+
+// A negamax node whose remaining moves are shared between threads
+// (Young Brothers Wait). It lives on the stack of the thread that created it,
+// which waits for every helper to detach before returning and helps out below
+// this node while it waits.
+struct SplitPoint
+{
+    SplitPoint(const EvalBoard &position, const chess::Movelist &moves, int firstMove,
+               int depth, int ply, int alpha, int beta, int bestScore, chess::Move bestMove,
+               SplitPoint *parent)
+        : position(position), moves(moves), depth(depth), ply(ply), beta(beta), parent(parent),
+          nextMove(firstMove), alpha(alpha), bestScore(bestScore), bestMove(bestMove)
+    {
+    }
+
+    const EvalBoard position; // board at the split node, helpers search from a copy
+    const chess::Movelist moves;
+    const int depth;
+    const int ply;
+    const int beta;
+    SplitPoint *const parent; // split point the master was working under
+
+    std::atomic<int> nextMove;     // index of the next unclaimed move
+    std::atomic<int> alpha;        // raised by whichever thread improves it
+    std::atomic<bool> cutoff{false};
+    std::atomic<int> helpers{0};   // helper threads attached to this node
+
+    std::mutex mutex; // guards bestScore and bestMove
+    int bestScore;
+    chess::Move bestMove;
+
+    bool hasWork() const
+    {
+        return !cutoff.load(std::memory_order_relaxed) &&
+               nextMove.load(std::memory_order_relaxed) < moves.size();
+    }
+
+    // True for split points opened in the subtree of ancestor
+    bool isBelow(const SplitPoint *ancestor) const
+    {
+        for (const SplitPoint *sp = parent; sp; sp = sp->parent)
+        {
+            if (sp == ancestor)
+                return true;
+        }
+        return false;
+    }
+
+    // A beta cutoff here or at any enclosing split point makes the subtree useless
+    bool aborted() const
+    {
+        for (const SplitPoint *sp = this; sp; sp = sp->parent)
+        {
+            if (sp->cutoff.load(std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    void update(int score, chess::Move move)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestMove = move;
+        }
+        if (score > alpha.load(std::memory_order_relaxed))
+        {
+            alpha.store(score, std::memory_order_relaxed);
+            if (score >= beta)
+                cutoff.store(true, std::memory_order_relaxed);
+        }
+    }
+};
+
+#endif // SPLIT_POINT_HPP
@@ -0,0 +1,127 @@
+#include "ChessEngine.hpp"
+#include <algorithm>
+
+bool ChessEngine::canSplit(int depth) const
+{
+    return parallelMode == ParallelMode::SPLIT_POINT &&
+           depth >= MIN_SPLIT_DEPTH &&
+           idleWorkers.load(std::memory_order_relaxed) > 0;
+}
+
+void ChessEngine::splitSearch(EvalBoard &board, const chess::Movelist &moves, int depth, int ply,
+                              int &alpha, int beta, int &bestScore, chess::Move &bestMove,
+                              SearchThread &thread)
+{
+    SplitPoint sp(board, moves, 1, depth, ply, alpha, beta, bestScore, bestMove, thread.splitPoint);
+
+    {
+        std::lock_guard<std::mutex> lock(splitMutex);
+        activeSplitPoints.push_back(&sp);
+    }
+    splitCondition.notify_all();
+
+    // The master keeps working through the moves on its own board
+    searchSplitMoves(sp, board, thread);
+
+    // Unpublish first so no new helper can attach, then wait for the ones still searching.
+    // Meanwhile the master helps with split points its helpers opened below this one,
+    // which are part of its own subtree, and sleeps when there is nothing to take.
+    {
+        std::unique_lock<std::mutex> lock(splitMutex);
+        activeSplitPoints.erase(std::find(activeSplitPoints.begin(), activeSplitPoints.end(), &sp));
+        while (sp.helpers.load(std::memory_order_acquire) > 0)
+        {
+            SplitPoint *child = findSplitPoint(&sp);
+            if (!child)
+            {
+                splitCondition.wait(lock);
+                continue;
+            }
+
+            child->helpers.fetch_add(1, std::memory_order_relaxed);
+            lock.unlock();
+
+            // board belongs to the node being split, work on a copy
+            EvalBoard childBoard = child->position;
+            searchSplitMoves(*child, childBoard, thread);
+
+            lock.lock();
+            child->helpers.fetch_sub(1, std::memory_order_release);
+            splitCondition.notify_all();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(sp.mutex);
+    alpha = sp.alpha.load(std::memory_order_relaxed);
+    bestScore = sp.bestScore;
+    bestMove = sp.bestMove;
+}
+
+void ChessEngine::searchSplitMoves(SplitPoint &sp, EvalBoard &board, SearchThread &thread)
+{
+    SplitPoint *previous = thread.splitPoint;
+    thread.splitPoint = &sp;
+
+    while (!shouldStop(thread))
+    {
+        int index = sp.nextMove.fetch_add(1, std::memory_order_relaxed);
+        if (index >= sp.moves.size())
+        {
+            break;
+        }
+
+        chess::Move move = sp.moves[index];
+        int alpha = sp.alpha.load(std::memory_order_relaxed);
+        int score = searchMove(board, move, index, sp.depth, sp.ply, alpha, sp.beta, thread);
+
+        if (shouldStop(thread))
+        {
+            break;
+        }
+
+        sp.update(score, move);
+    }
+
+    thread.splitPoint = previous;
+}
+
+SplitPoint *ChessEngine::findSplitPoint(const SplitPoint *ancestor) const
+{
+    for (SplitPoint *sp : activeSplitPoints)
+    {
+        if (sp->hasWork() && (!ancestor || sp->isBelow(ancestor)))
+        {
+            return sp;
+        }
+    }
+    return nullptr;
+}
+
+void ChessEngine::splitWorker(SearchThread &thread)
+{
+    std::unique_lock<std::mutex> lock(splitMutex);
+    while (true)
+    {
+        splitCondition.wait(lock, [this]()
+                            { return splitShutdown || findSplitPoint() != nullptr; });
+        if (splitShutdown)
+        {
+            return;
+        }
+
+        // Attaching happens under splitMutex, so the split point can't be unpublished meanwhile
+        SplitPoint *sp = findSplitPoint();
+        sp->helpers.fetch_add(1, std::memory_order_relaxed);
+        idleWorkers.fetch_sub(1, std::memory_order_relaxed);
+        lock.unlock();
+
+        thread.board = sp->position;
+        searchSplitMoves(*sp, thread.board, thread);
+
+        idleWorkers.fetch_add(1, std::memory_order_relaxed);
+        lock.lock();
+        // Last access to sp, its master may return as soon as this reaches zero
+        sp->helpers.fetch_sub(1, std::memory_order_release);
+        splitCondition.notify_all();
+    }
+}
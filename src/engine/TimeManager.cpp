@@ -0,0 +1,77 @@
+#include "TimeManager.hpp"
+#include <algorithm>
+
+namespace
+{
+    // Share of the soft limit used, by the number of iterations the best move survived
+    constexpr int STABILITY_SCALE[] = {140, 110, 90, 80, 70};
+    constexpr int MAX_STABILITY = 4;
+}
+
+void TimeManager::start(const SearchLimits &limits, chess::Color side)
+{
+    startTime = std::chrono::steady_clock::now();
+    softMs = NO_LIMIT;
+    hardMs = NO_LIMIT;
+    maxNodes = limits.nodes;
+    lastBestMove = chess::Move::NO_MOVE;
+    lastScore = 0;
+    stableIterations = 0;
+
+    // A fixed move time only has a hard deadline, iterations continue up to it
+    if (limits.movetime > 0)
+    {
+        hardMs = std::max<int64_t>(1, limits.movetime - MOVE_OVERHEAD);
+        return;
+    }
+
+    int64_t time = side == chess::Color::WHITE ? limits.wtime : limits.btime;
+    int64_t increment = side == chess::Color::WHITE ? limits.winc : limits.binc;
+    if (time <= 0)
+        return;
+
+    int64_t usable = std::max<int64_t>(1, time - MOVE_OVERHEAD);
+    int movesToGo = limits.movestogo > 0 ? limits.movestogo : DEFAULT_MOVES_TO_GO;
+    softMs = std::min(usable, time / movesToGo + increment * 3 / 4);
+    // Never bet more than half the clock on one move unless it is the last before the control
+    hardMs = std::min(softMs * HARD_LIMIT_FACTOR, std::max(softMs, usable / 2));
+}
+
+int64_t TimeManager::elapsed() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - startTime)
+        .count();
+}
+
+bool TimeManager::hardLimitReached(uint64_t nodes) const
+{
+    if (maxNodes > 0 && nodes >= maxNodes)
+        return true;
+    return hardMs != NO_LIMIT && elapsed() >= hardMs;
+}
+
+bool TimeManager::iterationDone(chess::Move bestMove, int score, uint64_t nodes)
+{
+    if (hardLimitReached(nodes))
+        return true;
+
+    bool firstIteration = lastBestMove == chess::Move::NO_MOVE;
+    stableIterations = bestMove == lastBestMove ? stableIterations + 1 : 0;
+    int scoreDrop = firstIteration ? 0 : lastScore - score;
+    lastBestMove = bestMove;
+    lastScore = score;
+
+    if (softMs == NO_LIMIT)
+        return false;
+
+    // Settle early on a stable best move, think longer when the score falls
+    int64_t scale = STABILITY_SCALE[std::min(stableIterations, MAX_STABILITY)];
+    if (scoreDrop > SCORE_DROP_MARGIN)
+        scale += std::min(scoreDrop, 100);
+    int64_t target = std::min(hardMs, softMs * scale / 100);
+
+    // The next iteration takes longer than all previous ones together, starting
+    // it past half the target would mostly end in an abort at the hard limit
+    return elapsed() >= target / 2;
+}
@@ -0,0 +1,71 @@
+#ifndef TIME_MANAGER_HPP
+#define TIME_MANAGER_HPP
+
+#include "../chess.hpp"
+#include <chrono>
+#include <cstdint>
+
+// Limits of one search, as given by a UCI "go" command. Zero means unset.
+struct SearchLimits
+{
+    int64_t wtime = 0;  // clock of each side in ms
+    int64_t btime = 0;
+    int64_t winc = 0;   // increment per move in ms
+    int64_t binc = 0;
+    int movestogo = 0;  // moves until the next time control, 0 = sudden death
+    int64_t movetime = 0; // search exactly this long
+    int depth = 0;
+    uint64_t nodes = 0;
+    bool ponder = false; // time and node limits only count after ChessEngine::ponderHit()
+
+    // False when only ChessEngine::stop() would end a search for side, as with "go infinite"
+    bool bounded(chess::Color side) const
+    {
+        return movetime > 0 || depth > 0 || nodes > 0 ||
+               (side == chess::Color::WHITE ? wtime : btime) > 0;
+    }
+};
+
+// Turns the search limits into deadlines. The soft limit is checked between
+// iterations and scaled by how settled the search looks, the hard limit
+// aborts the search in the middle of an iteration.
+class TimeManager
+{
+public:
+    void start(const SearchLimits &limits, chess::Color side);
+
+    int64_t elapsed() const;
+
+    // Hard deadline passed or node budget spent, the running iteration is abandoned
+    bool hardLimitReached(uint64_t nodes) const;
+
+    // Called by the main thread after every completed iteration, true when
+    // another iteration is not worth starting
+    bool iterationDone(chess::Move bestMove, int score, uint64_t nodes);
+
+    int64_t softLimit() const { return softMs; }
+    int64_t hardLimit() const { return hardMs; }
+
+    static constexpr int64_t NO_LIMIT = INT64_MAX;
+
+private:
+    // Time kept back for the GUI and communication lag
+    static constexpr int64_t MOVE_OVERHEAD = 30;
+    // Moves left assumed in sudden death games
+    static constexpr int DEFAULT_MOVES_TO_GO = 30;
+    // The hard deadline allows this many times the planned time
+    static constexpr int HARD_LIMIT_FACTOR = 4;
+    // A score drop larger than this extends the search
+    static constexpr int SCORE_DROP_MARGIN = 20;
+
+    std::chrono::steady_clock::time_point startTime;
+    int64_t softMs = NO_LIMIT;
+    int64_t hardMs = NO_LIMIT;
+    uint64_t maxNodes = 0;
+
+    chess::Move lastBestMove = chess::Move::NO_MOVE;
+    int lastScore = 0;
+    int stableIterations = 0; // iterations in a row that kept the best move
+};
+
+#endif // TIME_MANAGER_HPP
@@ -0,0 +1,46 @@
+#include "eval_cache.hpp"
+#include <algorithm>
+
+EvalCache::EvalCache(size_t size_mb) {
+    // Largest power-of-two entry count that fits in size_mb
+    size_t max_entries = std::max<size_t>(1, (size_mb * 1024 * 1024) / sizeof(uint64_t));
+    size_t num_entries = 1;
+    while (num_entries * 2 <= max_entries) {
+        num_entries *= 2;
+    }
+
+    table = std::make_unique<uint64_t[]>(num_entries);
+    index_mask = num_entries - 1;
+    clear();
+}
+
+void EvalCache::clear() {
+    std::fill(table.get(), table.get() + index_mask + 1, 0);
+    hits = 0;
+    misses = 0;
+}
+
+bool EvalCache::probe(uint64_t hash_key, int &eval) {
+    uint64_t data = table[hash_key & index_mask];
+    if ((data & KEY_MASK) == (hash_key & KEY_MASK)) {
+        eval = static_cast<int16_t>(data & 0xFFFF);
+        hits++;
+        return true;
+    }
+    misses++;
+    return false;
+}
+
+void EvalCache::store(uint64_t hash_key, int eval) {
+    table[hash_key & index_mask] = (hash_key & KEY_MASK) | static_cast<uint16_t>(eval);
+}
+
+EvalCacheStats EvalCache::get_stats() const {
+    EvalCacheStats stats;
+    stats.capacity = index_mask + 1;
+    stats.hits = hits;
+    stats.misses = misses;
+    size_t total_lookups = hits + misses;
+    stats.hit_rate = total_lookups > 0 ? (double)hits / total_lookups * 100.0 : 0.0;
+    return stats;
+}
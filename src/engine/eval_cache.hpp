@@ -0,0 +1,37 @@
+#ifndef EVAL_CACHE_HPP
+#define EVAL_CACHE_HPP
+
+#include <memory>
+#include <cstdint>
+
+struct EvalCacheStats
+{
+    size_t capacity;   // Dung lượng tối đa của bảng
+    size_t hits;       // Số lần tra cứu thành công
+    size_t misses;     // Số lần tra cứu thất bại
+    double hit_rate;   // Tỷ lệ hit (%)
+};
+
+// Direct-mapped, always-replace cache of static evaluations. It is kept apart
+// from the transposition table so search entries never evict it, and every
+// search thread owns one so there is no synchronisation.
+class EvalCache
+{
+public:
+    EvalCache(size_t size_mb = 1);
+    void clear();
+    bool probe(uint64_t hash_key, int &eval);
+    void store(uint64_t hash_key, int eval);
+    EvalCacheStats get_stats() const;
+
+private:
+    // Upper 48 bits of the zobrist key with the 16-bit evaluation in the low bits
+    std::unique_ptr<uint64_t[]> table;
+    uint64_t index_mask = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+
+    static constexpr uint64_t KEY_MASK = ~0xFFFFULL;
+};
+
+#endif // EVAL_CACHE_HPP
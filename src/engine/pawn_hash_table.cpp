@@ -0,0 +1,43 @@
+#include "pawn_hash_table.hpp"
+#include <algorithm>
+
+PawnHashTable::PawnHashTable(size_t size_mb) {
+    // Largest power-of-two entry count that fits in size_mb
+    size_t max_entries = std::max<size_t>(1, (size_mb * 1024 * 1024) / sizeof(PawnEntry));
+    size_t num_entries = 1;
+    while (num_entries * 2 <= max_entries) {
+        num_entries *= 2;
+    }
+
+    table = std::make_unique<PawnEntry[]>(num_entries);
+    index_mask = num_entries - 1;
+    clear();
+}
+
+void PawnHashTable::clear() {
+    // Key 0 (no pawns at all) maps to an all-zero entry, so empty slots are valid as is
+    std::fill(table.get(), table.get() + index_mask + 1, PawnEntry{});
+    hits = 0;
+    misses = 0;
+}
+
+PawnEntry &PawnHashTable::probe(uint64_t pawn_key, bool &found) {
+    PawnEntry &entry = table[pawn_key & index_mask];
+    found = entry.key == pawn_key;
+    if (found) {
+        hits++;
+    } else {
+        misses++;
+    }
+    return entry;
+}
+
+PawnHashStats PawnHashTable::get_stats() const {
+    PawnHashStats stats;
+    stats.capacity = index_mask + 1;
+    stats.hits = hits;
+    stats.misses = misses;
+    size_t total_lookups = hits + misses;
+    stats.hit_rate = total_lookups > 0 ? (double)hits / total_lookups * 100.0 : 0.0;
+    return stats;
+}
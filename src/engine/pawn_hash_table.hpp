@@ -0,0 +1,42 @@
+#ifndef PAWN_HASH_TABLE_HPP
+#define PAWN_HASH_TABLE_HPP
+
+#include <memory>
+#include <cstdint>
+#include "../chess.hpp"
+
+// Cached pawn structure terms, scores are from white's point of view
+struct PawnEntry
+{
+    uint64_t key = 0; // pawn-only zobrist key
+    int mid = 0;
+    int end = 0;
+};
+
+struct PawnHashStats
+{
+    size_t capacity;   // Dung lượng tối đa của bảng
+    size_t hits;       // Số lần tra cứu thành công
+    size_t misses;     // Số lần tra cứu thất bại
+    double hit_rate;   // Tỷ lệ hit (%)
+};
+
+// Fixed-size, always-replace table. Each search thread owns one, so there is
+// no synchronisation.
+class PawnHashTable
+{
+public:
+    PawnHashTable(size_t size_mb = 1);
+    void clear();
+    // Returns the slot for pawn_key, found tells whether it already holds it
+    PawnEntry &probe(uint64_t pawn_key, bool &found);
+    PawnHashStats get_stats() const;
+
+private:
+    std::unique_ptr<PawnEntry[]> table;
+    uint64_t index_mask = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+};
+
+#endif // PAWN_HASH_TABLE_HPP
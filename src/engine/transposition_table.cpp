@@ -1,70 +1,187 @@
 #include "transposition_table.hpp"
+#include <algorithm>
 
 TranspositionTable::TranspositionTable(size_t size_mb) {
-    capacity = (size_mb * 1024 * 1024) / sizeof(TranspositionEntry);
-    table.reserve(capacity);
+    counters = std::make_unique<Counters[]>(num_counters);
+    resize(size_mb);
+}
+
+void TranspositionTable::resize(size_t size_mb) {
+    // Largest power-of-two bucket count that fits in size_mb
+    size_t max_buckets = std::max<size_t>(1, (size_mb * 1024 * 1024) / sizeof(TTBucket));
+    size_t num_buckets = 1;
+    while (num_buckets * 2 <= max_buckets) {
+        num_buckets *= 2;
+    }
+
+    // Free the old buckets first so the old and new table are never both allocated
+    table.reset();
+    table = std::make_unique<TTBucket[]>(num_buckets);
+    bucket_mask = num_buckets - 1;
+    capacity = num_buckets * TT_BUCKET_SIZE;
+    clear();
 }
 
 void TranspositionTable::clear() {
-    table.clear();
-    hits = 0;
-    misses = 0;
-    collisions = 0;
+    for (size_t i = 0; i <= bucket_mask; i++) {
+        for (auto &entry : table[i].entries) {
+            entry.store(0, std::memory_order_relaxed);
+        }
+    }
+    for (int i = 0; i < num_counters; i++) {
+        counters[i].used = 0;
+        counters[i].current_generation = 0;
+        counters[i].hits = 0;
+        counters[i].misses = 0;
+        counters[i].collisions = 0;
+    }
     current_age = 0;
 }
 
-void TranspositionTable::store(uint64_t hash_key, int score, TTFlag flag, int depth) {
-    TranspositionEntry entry = {score, flag, depth};
-    if (table.find(hash_key) != table.end()) {
-        auto& existing = table[hash_key];
-        if (depth >= existing.depth || flag == TTFlag::EXACT_SCORE || current_age > existing.age + 2) {
-            table[hash_key] = entry;
-        } else {
-            collisions++;
+void TranspositionTable::set_threads(int threads) {
+    threads = std::max(1, threads);
+    if (threads == num_counters) {
+        return;
+    }
+
+    // Carry the totals over into the first slot so stats survive the resize
+    TTStats stats = get_stats();
+    num_counters = threads;
+    counters = std::make_unique<Counters[]>(num_counters);
+    counters[0].used = stats.size;
+    counters[0].current_generation = stats.current_generation;
+    counters[0].hits = stats.hits;
+    counters[0].misses = stats.misses;
+    counters[0].collisions = stats.collisions;
+}
+
+void TranspositionTable::store(uint64_t hash_key, int score, TTFlag flag, int depth,
+                               chess::Move move, int thread) {
+    TTBucket &bucket = bucket_for(hash_key);
+    Counters &stats = counters[thread];
+    uint16_t key = key_for(hash_key);
+    uint8_t stored_depth = static_cast<uint8_t>(std::clamp(depth + 1, 1, 255));
+
+    // Prefer the slot already holding this position, then an empty one, otherwise
+    // evict the entry that is shallowest once its age is taken into account
+    std::atomic<uint64_t> *slot = &bucket.entries[0];
+    TranspositionEntry replace = TranspositionEntry::unpack(slot->load(std::memory_order_relaxed));
+    int worst_value = 1 << 30;
+    for (auto &candidate : bucket.entries) {
+        TranspositionEntry entry = TranspositionEntry::unpack(candidate.load(std::memory_order_relaxed));
+        if (entry.depth == 0 || entry.key == key) {
+            slot = &candidate;
+            replace = entry;
+            break;
+        }
+        int value = entry.depth - 8 * relative_age(entry);
+        if (value < worst_value) {
+            worst_value = value;
+            slot = &candidate;
+            replace = entry;
+        }
+    }
+
+    if (replace.depth != 0 && replace.key == key) {
+        // Keep the previous best move when the new search didn't produce one
+        if (move.move() == chess::Move::NO_MOVE) {
+            move = chess::Move(replace.move);
+        }
+        // Same position: keep a deeper result from this search unless the new one is exact
+        if (stored_depth < replace.depth && flag != TTFlag::EXACT_SCORE &&
+            relative_age(replace) == 0) {
+            replace.move = move.move();
+            slot->store(replace.pack(), std::memory_order_relaxed);
+            bump(stats.collisions);
+            return;
         }
+    } else if (replace.depth == 0) {
+        bump(stats.used);
     } else {
-        table[hash_key] = entry;
+        bump(stats.collisions);
     }
+
+    if (replace.depth == 0 || relative_age(replace) != 0) {
+        bump(stats.current_generation);
+    }
+
+    TranspositionEntry entry;
+    entry.key = key;
+    entry.move = move.move();
+    entry.score = static_cast<int16_t>(score);
+    entry.depth = stored_depth;
+    entry.genBound = static_cast<uint8_t>((current_age << 2) | static_cast<uint8_t>(flag));
+    slot->store(entry.pack(), std::memory_order_relaxed);
 }
 
-std::tuple<bool, int> TranspositionTable::lookup(uint64_t hash_key, int depth, int alpha, int beta) {
-    auto it = table.find(hash_key);
-    if (it != table.end()) {
-        const auto& entry = it->second;
-        if (entry.depth >= depth) {
-            hits++;
-            if (entry.flag == TTFlag::EXACT_SCORE) {
-                return {true, entry.score};
-            } else if (entry.flag == TTFlag::LOWER_BOUND && entry.score >= beta) {
-                return {true, entry.score};
-            } else if (entry.flag == TTFlag::UPPER_BOUND && entry.score <= alpha) {
-                return {true, entry.score};
+TTProbe TranspositionTable::lookup(uint64_t hash_key, int depth, int alpha, int beta, int thread) {
+    const TTBucket &bucket = bucket_for(hash_key);
+    Counters &stats = counters[thread];
+    uint16_t key = key_for(hash_key);
+    TTProbe probe;
+
+    for (const auto &slot : bucket.entries) {
+        TranspositionEntry entry = TranspositionEntry::unpack(slot.load(std::memory_order_relaxed));
+        if (entry.depth == 0 || entry.key != key) {
+            continue;
+        }
+        probe.found = true;
+        probe.score = entry.score;
+        probe.depth = entry.searchDepth();
+        probe.flag = entry.flag();
+        probe.move = chess::Move(entry.move);
+        if (probe.depth >= depth) {
+            bump(stats.hits);
+            if (probe.flag == TTFlag::EXACT_SCORE) {
+                probe.cutoff = true;
+            } else if (probe.flag == TTFlag::LOWER_BOUND && probe.score >= beta) {
+                probe.cutoff = true;
+            } else if (probe.flag == TTFlag::UPPER_BOUND && probe.score <= alpha) {
+                probe.cutoff = true;
+            }
+            if (probe.cutoff) {
+                return probe;
             }
         }
+        break;
     }
-    misses++;
-    return {false, 0};
+    bump(stats.misses);
+    return probe;
 }
 
 TTStats TranspositionTable::get_stats() const {
+    size_t used = 0, current_generation = 0, hits = 0, misses = 0, collisions = 0;
+    for (int i = 0; i < num_counters; i++) {
+        used += counters[i].used.load(std::memory_order_relaxed);
+        current_generation += counters[i].current_generation.load(std::memory_order_relaxed);
+        hits += counters[i].hits.load(std::memory_order_relaxed);
+        misses += counters[i].misses.load(std::memory_order_relaxed);
+        collisions += counters[i].collisions.load(std::memory_order_relaxed);
+    }
+    // Threads racing for the same empty slot can both count it
+    used = std::min(used, capacity);
+    current_generation = std::min(current_generation, capacity);
+
     size_t total_lookups = hits + misses;
     double hit_rate = (total_lookups > 0) ? (static_cast<double>(hits) / total_lookups * 100.0) : 0.0;
-    double usage = (capacity > 0) ? (static_cast<double>(table.size()) / capacity * 100.0) : 0.0;
+    double usage = (capacity > 0) ? (static_cast<double>(used) / capacity * 100.0) : 0.0;
 
     return TTStats{
-        table.size(),   // size
+        used,           // size
         capacity,       // capacity
         usage,          // usage
         hits,           // hits
         misses,         // misses
         hit_rate,       // hit_rate
-        collisions      // collisions
+        collisions,     // collisions
+        current_generation // current_generation
     };
 }
 
 void TranspositionTable::increment_age() {
-    current_age++;  
-    if (current_age == 255) {
-        clear();  // Reset table if age reaches max to avoid issues
+    // Generations wrap around; relative_age() handles the overflow so the table is never wiped
+    current_age = (current_age + 1) & (GENERATION_CYCLE - 1);
+    for (int i = 0; i < num_counters; i++) {
+        counters[i].current_generation = 0;
     }
-}
\ No newline at end of file
+}
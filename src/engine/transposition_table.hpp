@@ -1,9 +1,10 @@
 #ifndef TRANSPOSITION_TABLE_HPP
 #define TRANSPOSITION_TABLE_HPP
 
-#include <unordered_map>
+#include <atomic>
+#include <bit>
+#include <memory>
 #include <cstdint>
-#include <tuple>
 #include "../chess.hpp"
 
 enum class TTFlag
@@ -13,12 +14,46 @@ enum class TTFlag
     LOWER_BOUND = 2
 };
 
+// Compact 8-byte entry, eight of them share one 64-byte bucket
 struct TranspositionEntry
 {
-    int score;
-    TTFlag flag;
-    int depth;
-    int age;
+    uint16_t key;     // upper 16 bits of the zobrist key, verifies the slot
+    uint16_t move;    // raw chess::Move value of the best move
+    int16_t score;
+    uint8_t depth;    // search depth + 1, 0 marks an empty slot
+    uint8_t genBound; // generation in the upper 6 bits, TTFlag in the lower 2
+
+    TTFlag flag() const { return static_cast<TTFlag>(genBound & 0x3); }
+    uint8_t generation() const { return genBound >> 2; }
+    int searchDepth() const { return depth - 1; }
+
+    uint64_t pack() const { return std::bit_cast<uint64_t>(*this); }
+    static TranspositionEntry unpack(uint64_t data) { return std::bit_cast<TranspositionEntry>(data); }
+};
+
+static_assert(sizeof(TranspositionEntry) == 8, "TT entry must stay 8 bytes");
+
+constexpr int TT_BUCKET_SIZE = 8;
+
+// Each entry is a single 64-bit atomic word, so the key slice and the data it
+// verifies are always read and written together and threads can share the
+// table without locks
+struct alignas(64) TTBucket
+{
+    std::atomic<uint64_t> entries[TT_BUCKET_SIZE];
+};
+
+static_assert(sizeof(TTBucket) == 64, "TT bucket must fill exactly one cache line");
+
+// Result of a probe: the stored move is returned even when the bound can't cut
+struct TTProbe
+{
+    bool found = false;  // position is in the table
+    bool cutoff = false; // stored bound allows returning score directly
+    int score = 0;
+    int depth = -1;
+    TTFlag flag = TTFlag::UPPER_BOUND;
+    chess::Move move = chess::Move::NO_MOVE;
 };
 
 struct TTStats
@@ -30,6 +65,7 @@ struct TTStats
     size_t misses;     // Số lần tra cứu thất bại
     double hit_rate;   // Tỷ lệ hit (%)
     size_t collisions; // Số lần va chạm khi lưu entry
+    size_t current_generation; // Số entry được ghi trong lần tìm kiếm hiện tại
 };
 
 class TranspositionTable
@@ -37,18 +73,49 @@ class TranspositionTable
 public:
     TranspositionTable(size_t size_mb = 64);
     void clear();
-    void store(uint64_t hash_key, int score, TTFlag flag, int depth);
-    std::tuple<bool, int> lookup(uint64_t hash_key, int depth, int alpha, int beta);
+
+    // Reallocate for size_mb and clear, must not be called while a search is running
+    void resize(size_t size_mb);
+    void store(uint64_t hash_key, int score, TTFlag flag, int depth,
+               chess::Move move = chess::Move::NO_MOVE, int thread = 0);
+    TTProbe lookup(uint64_t hash_key, int depth, int alpha, int beta, int thread = 0);
     TTStats get_stats() const;
     void increment_age();
 
+    // Resize the per-thread counters, must not be called while a search is running
+    void set_threads(int threads);
+
 private:
-    std::unordered_map<uint64_t, TranspositionEntry> table;
-    size_t hits = 0;
-    size_t misses = 0;
-    size_t collisions = 0;
+    static constexpr int GENERATION_CYCLE = 64; // 6 bits of genBound
+
+    // Counters are kept per search thread on their own cache line and only
+    // written by their owner, get_stats() sums them
+    struct alignas(64) Counters
+    {
+        std::atomic<size_t> used{0};
+        std::atomic<size_t> current_generation{0};
+        std::atomic<size_t> hits{0};
+        std::atomic<size_t> misses{0};
+        std::atomic<size_t> collisions{0};
+    };
+
+    std::unique_ptr<TTBucket[]> table;
+    std::unique_ptr<Counters[]> counters;
+    int num_counters = 1;
+    uint64_t bucket_mask = 0;
     size_t capacity;
     int current_age = 0;
+
+    TTBucket &bucket_for(uint64_t hash_key) { return table[hash_key & bucket_mask]; }
+    static uint16_t key_for(uint64_t hash_key) { return static_cast<uint16_t>(hash_key >> 48); }
+    int relative_age(const TranspositionEntry &entry) const
+    {
+        return (current_age - entry.generation()) & (GENERATION_CYCLE - 1);
+    }
+    static void bump(std::atomic<size_t> &counter)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
 };
 
-#endif // TRANSPOSITION_TABLE_HPP
\ No newline at end of file
+#endif // TRANSPOSITION_TABLE_HPP
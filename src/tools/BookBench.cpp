@@ -0,0 +1,64 @@
+// Opening book load benchmark: parses a PGN file into a fresh book repeatedly
+//
+// Usage: bookbench [pgn file] [runs]
+
+#include "../engine/OpeningMove.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+int main(int argc, char **argv)
+{
+    std::string path = argc > 1 ? argv[1] : "assets/opening/Adams.pgn";
+    int runs = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10;
+
+    std::error_code error;
+    auto bytes = std::filesystem::file_size(path, error);
+    if (error)
+    {
+        std::cerr << "Cannot read " << path << std::endl;
+        return 1;
+    }
+
+    std::cout << "Book load benchmark: " << path << " (" << bytes / 1024 << " KB), "
+              << runs << " runs\n\n";
+
+    double best = 0.0, total = 0.0;
+    size_t positions = 0;
+    for (int i = 0; i < runs; i++)
+    {
+        // The book reports every load on stdout, keep it out of the table
+        std::ostringstream quiet;
+        auto *previous = std::cout.rdbuf(quiet.rdbuf());
+
+        auto start = std::chrono::steady_clock::now();
+        OpeningMove book;
+        bool loaded = book.initializeFromFile(path);
+        auto end = std::chrono::steady_clock::now();
+
+        std::cout.rdbuf(previous);
+        if (!loaded)
+        {
+            std::cerr << "Failed to load " << path << std::endl;
+            return 1;
+        }
+
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        best = i == 0 ? ms : std::min(best, ms);
+        total += ms;
+        positions = book.getPositionCount();
+        std::cout << "run " << std::setw(3) << i + 1 << ": " << std::fixed << std::setprecision(2)
+                  << std::setw(9) << ms << " ms\n";
+    }
+
+    std::cout << "\nPositions: " << positions
+              << "\nBest: " << std::fixed << std::setprecision(2) << best << " ms"
+              << ", average: " << total / runs << " ms"
+              << ", " << std::setprecision(1) << bytes / (best / 1000.0) / (1024 * 1024) << " MB/s\n";
+    return 0;
+}
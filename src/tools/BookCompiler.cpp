@@ -0,0 +1,119 @@
+// Opening book compiler: turns PGN files into a Polyglot .bin book that the
+// engine memory-maps instead of parsing PGN at startup. Games are counted on
+// several threads; the book does not depend on the thread count.
+//
+// Usage: bookcompiler <output.bin> <pgn file or directory>... [-plies N] [-threads N]
+
+#include "../engine/BookBuilder.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // PGN files given directly, or found in a directory
+    std::vector<std::string> collectPgnFiles(const std::string &input)
+    {
+        std::vector<std::string> files;
+        if (std::filesystem::is_directory(input))
+        {
+            for (const auto &entry : std::filesystem::directory_iterator(input))
+            {
+                if (entry.is_regular_file() && entry.path().extension() == ".pgn")
+                {
+                    files.push_back(entry.path().string());
+                }
+            }
+            // Directory order is unspecified, keep the output reproducible
+            std::sort(files.begin(), files.end());
+        }
+        else
+        {
+            files.push_back(input);
+        }
+        return files;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::string output;
+    std::vector<std::string> inputs;
+    int plies = 12;
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-plies" && i + 1 < argc)
+        {
+            plies = std::atoi(argv[++i]);
+        }
+        else if (arg == "-threads" && i + 1 < argc)
+        {
+            threads = std::atoi(argv[++i]);
+        }
+        else if (output.empty())
+        {
+            output = arg;
+        }
+        else
+        {
+            inputs.push_back(arg);
+        }
+    }
+
+    if (output.empty() || inputs.empty() || plies <= 0)
+    {
+        std::cerr << "Usage: bookcompiler <output.bin> <pgn file or directory>... [-plies N] [-threads N]" << std::endl;
+        return 1;
+    }
+    threads = std::max(1, threads);
+
+    BookBuilder builder(plies, threads);
+    for (const auto &input : inputs)
+    {
+        for (const auto &file : collectPgnFiles(input))
+        {
+            std::cout << "Reading " << file << std::endl;
+            if (!builder.addFile(file))
+            {
+                return 1;
+            }
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<PolyglotEntry> entries = builder.entries();
+    if (!PolyglotBook::write(output, entries))
+    {
+        std::cerr << "Failed to write " << output << std::endl;
+        return 1;
+    }
+    double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t positions = 0;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        positions += i == 0 || entries[i].key != entries[i - 1].key;
+    }
+
+    const BookBuildStats &stats = builder.getStats();
+    double seconds = std::max(stats.seconds, 1e-6);
+    std::cout << std::fixed << std::setprecision(0)
+              << "Read " << stats.files << " files, " << stats.bytes / (1024 * 1024) << " MB, "
+              << stats.games << " games (" << stats.skippedGames << " with unreadable moves) in "
+              << std::setprecision(3) << stats.seconds << " s on " << threads << " threads\n"
+              << std::setprecision(0)
+              << "  " << stats.games / seconds << " games/s, " << stats.positions / seconds << " positions/s, "
+              << std::setprecision(1) << stats.bytes / seconds / (1024 * 1024) << " MB/s\n"
+              << "Wrote " << output << ": " << positions << " positions, " << entries.size() << " entries, "
+              << plies << " plies, merged and written in " << std::setprecision(3) << writeSeconds << " s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,196 @@
+// Move generator test and benchmark: counts the leaf nodes of the legal move
+// tree of chess.hpp and compares them with published perft results
+//
+// Usage: perft                                  run the standard suite
+//        perft <depth> [fen] [-divide] [-threads N]
+
+#include "../chess.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct PerftPosition
+    {
+        const char *name;
+        const char *fen;
+        int depth;
+        uint64_t nodes; // expected leaf count at depth
+    };
+
+    // Positions and counts from the Chess Programming Wiki "Perft Results" page
+    const std::vector<PerftPosition> SUITE = {
+        {"startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 6, 119060324},
+        {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 5, 193690690},
+        {"position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6, 11030083},
+        {"position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5, 15833292},
+        {"position 4 mirrored", "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", 5, 15833292},
+        {"position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 5, 89941194},
+        {"position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 5, 164075551},
+    };
+
+    // Leaf nodes below board, the last ply is counted from the move list
+    // without making the moves
+    uint64_t perft(chess::Board &board, int depth)
+    {
+        chess::Movelist moves;
+        chess::movegen::legalmoves(moves, board);
+        if (depth <= 1)
+        {
+            return depth == 1 ? moves.size() : 1;
+        }
+
+        uint64_t nodes = 0;
+        for (const auto &move : moves)
+        {
+            board.makeMove(move);
+            nodes += perft(board, depth - 1);
+            board.unmakeMove(move);
+        }
+        return nodes;
+    }
+
+    // Leaf count below every root move. Threads take root moves from a shared
+    // counter, each on its own copy of the board.
+    std::vector<uint64_t> perftRoot(const chess::Board &root, int depth, int threads, chess::Movelist &moves)
+    {
+        chess::movegen::legalmoves(moves, root);
+        std::vector<uint64_t> counts(moves.size(), 0);
+        if (depth <= 0)
+        {
+            return counts;
+        }
+
+        std::atomic<int> nextMove{0};
+        auto work = [&]()
+        {
+            chess::Board board = root;
+            for (int i = nextMove++; i < moves.size(); i = nextMove++)
+            {
+                board.makeMove(moves[i]);
+                counts[i] = perft(board, depth - 1);
+                board.unmakeMove(moves[i]);
+            }
+        };
+
+        std::vector<std::thread> helpers;
+        for (int i = 1; i < threads; i++)
+        {
+            helpers.emplace_back(work);
+        }
+        work();
+        for (auto &helper : helpers)
+        {
+            helper.join();
+        }
+        return counts;
+    }
+
+    struct PerftResult
+    {
+        uint64_t nodes;
+        double seconds;
+    };
+
+    PerftResult run(const std::string &fen, int depth, int threads, bool divide)
+    {
+        chess::Board board(fen);
+        chess::Movelist moves;
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = 1;
+        if (depth > 0)
+        {
+            std::vector<uint64_t> counts = perftRoot(board, depth, threads, moves);
+            nodes = 0;
+            for (size_t i = 0; i < counts.size(); i++)
+            {
+                nodes += counts[i];
+                if (divide)
+                {
+                    std::cout << chess::uci::moveToUci(moves[i]) << ": " << counts[i] << "\n";
+                }
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return {nodes, seconds};
+    }
+
+    double mnps(const PerftResult &result)
+    {
+        return result.seconds > 0 ? result.nodes / result.seconds / 1e6 : 0.0;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int depth = 0;
+    int threads = 1;
+    bool divide = false;
+    std::string fen = chess::STARTPOS;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-divide")
+        {
+            divide = true;
+        }
+        else if (arg == "-threads" && i + 1 < argc)
+        {
+            threads = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (depth == 0)
+        {
+            depth = std::atoi(arg.c_str());
+        }
+        else
+        {
+            fen = arg;
+        }
+    }
+
+    std::cout << std::fixed;
+
+    if (depth > 0)
+    {
+        PerftResult result = run(fen, depth, threads, divide);
+        std::cout << "\nNodes: " << result.nodes
+                  << "\nTime: " << std::setprecision(3) << result.seconds << " s"
+                  << "\nSpeed: " << std::setprecision(2) << mnps(result) << " Mnps" << std::endl;
+        return 0;
+    }
+
+    std::cout << "Perft suite, " << threads << " thread" << (threads > 1 ? "s" : "") << "\n\n"
+              << std::left << std::setw(22) << "position" << std::right << std::setw(6) << "depth"
+              << std::setw(13) << "nodes" << std::setw(10) << "ms" << std::setw(9) << "Mnps" << "  result\n";
+
+    uint64_t totalNodes = 0;
+    double totalSeconds = 0.0;
+    int failures = 0;
+    for (const auto &position : SUITE)
+    {
+        PerftResult result = run(position.fen, position.depth, threads, false);
+        bool passed = result.nodes == position.nodes;
+        failures += !passed;
+        totalNodes += result.nodes;
+        totalSeconds += result.seconds;
+
+        std::cout << std::left << std::setw(22) << position.name << std::right << std::setw(6) << position.depth
+                  << std::setw(13) << result.nodes << std::setw(10) << std::setprecision(0) << result.seconds * 1000
+                  << std::setw(9) << std::setprecision(2) << mnps(result) << "  "
+                  << (passed ? "ok" : "FAILED, expected " + std::to_string(position.nodes)) << "\n";
+    }
+
+    std::cout << "\nTotal: " << totalNodes << " nodes in " << std::setprecision(3) << totalSeconds << " s, "
+              << std::setprecision(2) << mnps({totalNodes, totalSeconds}) << " Mnps\n"
+              << (failures == 0 ? "All positions passed" : std::to_string(failures) + " positions FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
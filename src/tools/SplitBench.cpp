@@ -0,0 +1,86 @@
+// Time-to-depth benchmark: serial search versus the split point (YBWC) backend
+//
+// Usage: splitbench [depth] [threads]
+
+#include "../engine/ChessEngine.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const std::vector<std::string> POSITIONS = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1B1PPP/R2QKB1R w KQ - 0 8",
+        "2r3k1/pp3ppp/4p3/3p4/3P4/1P2P3/P4PPP/2R3K1 w - - 0 25",
+    };
+
+    struct RunResult
+    {
+        long long ms;
+        uint64_t nodes;
+        chess::Move move;
+    };
+
+    RunResult run(ChessEngine &engine, const std::string &fen)
+    {
+        engine.clearHash();
+        chess::Board board(fen);
+        auto start = std::chrono::steady_clock::now();
+        chess::Move move = engine.getBestMove(board);
+        auto end = std::chrono::steady_clock::now();
+        return {std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count(),
+                engine.getLastSearchNodes(), move};
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int depth = argc > 1 ? std::atoi(argv[1]) : 6;
+    int threads = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+    threads = std::max(1, threads);
+
+    ChessEngine engine(false);
+    engine.setVerbose(false);
+    engine.setMaxDepth(depth);
+
+    std::cout << "Split point benchmark: depth " << depth << ", " << threads << " threads\n\n";
+    std::cout << std::left << std::setw(4) << "#"
+              << std::right << std::setw(12) << "serial ms" << std::setw(12) << "split ms"
+              << std::setw(10) << "speedup" << std::setw(14) << "serial nodes"
+              << std::setw(14) << "split nodes" << "\n";
+
+    long long serialTotal = 0, splitTotal = 0;
+    for (size_t i = 0; i < POSITIONS.size(); i++)
+    {
+        engine.setThreads(1);
+        engine.setParallelMode(ChessEngine::ParallelMode::LAZY_SMP);
+        RunResult serial = run(engine, POSITIONS[i]);
+
+        engine.setThreads(threads);
+        engine.setParallelMode(ChessEngine::ParallelMode::SPLIT_POINT);
+        RunResult split = run(engine, POSITIONS[i]);
+
+        serialTotal += serial.ms;
+        splitTotal += split.ms;
+
+        double speedup = split.ms > 0 ? static_cast<double>(serial.ms) / split.ms : 0.0;
+        std::cout << std::left << std::setw(4) << i + 1
+                  << std::right << std::setw(12) << serial.ms << std::setw(12) << split.ms
+                  << std::setw(10) << std::fixed << std::setprecision(2) << speedup
+                  << std::setw(14) << serial.nodes << std::setw(14) << split.nodes << "\n";
+    }
+
+    double speedup = splitTotal > 0 ? static_cast<double>(serialTotal) / splitTotal : 0.0;
+    std::cout << "\nTotal time-to-depth: serial " << serialTotal << " ms, split " << splitTotal
+              << " ms, speedup " << std::fixed << std::setprecision(2) << speedup << "x\n";
+    return 0;
+}
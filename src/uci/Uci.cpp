@@ -0,0 +1,395 @@
+#include "Uci.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <initializer_list>
+#include <vector>
+
+namespace
+{
+    // Openings, middlegames and endgames of all kinds, the perft positions among them
+    const std::vector<std::string> BENCH_POSITIONS = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+        "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+        "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+        "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+        "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+        "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+        "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+        "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+        "2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+        "r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+        "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+        "r1q2rk1/2p1bppp/2Pp4/p6b/Q1PNp3/4B3/PP1R1PPP/2K4R w - - 2 18",
+        "4k2r/1pb2ppp/1p2p3/1R1p4/3P4/2r1PN2/P4PPP/1R4K1 b - - 3 22",
+        "3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
+        "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/8 b - - 3 54",
+        "2K5/p7/7P/5pR1/8/5k2/r7/8 w - - 0 1",
+        "8/6pk/1p6/8/PP3p1p/5P2/4KP1q/3Q4 w - - 0 1",
+        "7k/3p2pp/4q3/8/4Q3/5Kp1/P6b/8 w - - 0 1",
+        "8/2p5/8/2kPKp1p/2p4P/2P5/3P4/8 w - - 0 1",
+        "8/1p3pp1/7p/5P1P/2k3P1/8/2K2P2/8 w - - 0 1",
+        "8/pp2r1k1/2p1p3/3pP2p/1P1P1P1P/P5KR/8/8 w - - 0 1",
+        "8/3p4/p1bk3p/Pp6/1Kp1PpPp/2P2P1P/2P5/5B2 b - - 0 1",
+        "5k2/7R/4P2p/5K2/p1r2P1p/8/8/8 b - - 0 1",
+        "6k1/6p1/P6p/r1N5/5p2/7P/1b3PP1/4R1K1 w - - 0 1",
+        "1r3k2/4q3/2Pp3b/3Bp3/2Q2p2/1p1P2P1/1P2KP2/3N4 w - - 0 1",
+        "6k1/4pp1p/3p2p1/P1pPb3/R7/1r2P1PP/3B1P2/6K1 w - - 0 1",
+        "8/3p3B/5p2/5P2/p7/PP5b/k7/6K1 w - - 0 1",
+        "5rk1/q6p/2p3bR/1pPp1rP1/1P1Pp3/P3B1Q1/1K3P2/R7 w - - 93 90",
+        "4rrk1/1p1nq3/p7/2p1P1pp/3P2bp/3Q1Bn1/PPPB4/1K2R1NR w - - 40 21",
+        "r3k2r/3nnpbp/q2pp1p1/p7/Pp1PPPP1/4BNN1/1P5P/R2Q1RK1 w kq - 0 16",
+        "3Qb1k1/1r2ppb1/pN1n2q1/Pp1Pp1Pr/4P2p/4BP2/4B1R1/1R5K b - - 11 40",
+        "4k3/3q1r2/1N2r1b1/3ppN2/2nPP3/1B1R2n1/2R1Q3/3K4 w - - 5 1",
+        "8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+        "8/8/8/5N2/8/p7/8/2NK3k w - - 0 1",
+        "8/3k4/8/8/8/4B3/4KB2/2B5 w - - 0 1",
+        "8/8/1P6/5pr1/8/4R3/7k/2K5 w - - 0 1",
+        "8/2p4P/8/kr6/6R1/8/8/1K6 w - - 0 1",
+        "8/8/3P3k/8/1p6/8/1P6/1K3n2 b - - 0 1",
+        "8/R7/2q5/8/6k1/8/1P5p/K6R w - - 0 124",
+        "6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q1p1/1R1RB1P1/5K2 b - - 0 1",
+        "r2r1n2/pp2bk2/2p1p2p/3q4/3PN1QP/2P3R1/P4PP1/5RK1 w - - 0 1",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1B1PPP/R2QKB1R w KQ - 0 8",
+        "2r3k1/pp3ppp/4p3/3p4/3P4/1P2P3/P4PPP/2R3K1 w - - 0 25",
+        "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+        "rnbqkb1r/pp3ppp/4pn2/2pp4/2PP4/2N2N2/PP2PPPP/R1BQKB1R w KQkq - 0 5",
+    };
+}
+
+Uci::Uci(std::ostream &out)
+    : out(out)
+{
+    engine.setVerbose(false);
+    engine.setInfoCallback([this](const ChessEngine::SearchStats &stats)
+                           { sendInfo(stats); });
+}
+
+Uci::~Uci()
+{
+    waitForSearch();
+}
+
+void Uci::loop(std::istream &in)
+{
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream args(line);
+        std::string command;
+        args >> command;
+
+        if (command == "uci")
+            uci();
+        else if (command == "isready")
+            send("readyok");
+        else if (command == "ucinewgame")
+        {
+            waitForSearch();
+            engine.clearHash();
+            board = chess::Board();
+        }
+        else if (command == "setoption")
+            setOption(args);
+        else if (command == "position")
+            position(args);
+        else if (command == "go")
+            go(args);
+        else if (command == "stop")
+            stop();
+        else if (command == "ponderhit")
+            ponderHit();
+        else if (command == "bench")
+            bench(args);
+        else if (command == "quit")
+            break;
+        else if (!command.empty())
+            send("info string unknown command: " + command);
+    }
+}
+
+void Uci::bench(std::istringstream &args)
+{
+    waitForSearch();
+
+    // Missing arguments keep their defaults, a failed read would set them to 0
+    int hashMb = BENCH_HASH_MB;
+    int threads = 1;
+    int depth = BENCH_DEPTH;
+    for (int *value : {&hashMb, &threads, &depth})
+    {
+        int read;
+        if (!(args >> read))
+            break;
+        *value = read;
+    }
+
+    // A separate engine so the bench does not depend on, or change, the options set over UCI
+    ChessEngine benchEngine(false);
+    benchEngine.setVerbose(false);
+    benchEngine.setHashSize(std::clamp(hashMb, 1, MAX_HASH_MB));
+    benchEngine.setThreads(std::clamp(threads, 1, MAX_THREADS));
+
+    SearchLimits limits;
+    limits.depth = std::max(1, depth);
+
+    uint64_t totalNodes = 0;
+    int64_t totalMs = 0;
+    for (size_t i = 0; i < BENCH_POSITIONS.size(); i++)
+    {
+        benchEngine.clearHash();
+        chess::Board position(BENCH_POSITIONS[i]);
+
+        auto start = std::chrono::steady_clock::now();
+        chess::Move bestMove = benchEngine.getBestMove(position, limits);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+
+        uint64_t nodes = benchEngine.getLastSearchNodes();
+        totalNodes += nodes;
+        totalMs += ms;
+        send("Position " + std::to_string(i + 1) + "/" + std::to_string(BENCH_POSITIONS.size()) +
+             ": bestmove " + chess::uci::moveToUci(bestMove) + " nodes " + std::to_string(nodes) +
+             " time " + std::to_string(ms));
+    }
+
+    send("===========================");
+    send("Total time (ms) : " + std::to_string(totalMs));
+    send("Nodes searched  : " + std::to_string(totalNodes));
+    send("Nodes/second    : " + std::to_string(totalMs > 0 ? totalNodes * 1000 / totalMs : 0));
+}
+
+void Uci::send(const std::string &line)
+{
+    std::lock_guard<std::mutex> lock(outMutex);
+    out << line << std::endl;
+}
+
+void Uci::sendInfo(const ChessEngine::SearchStats &stats)
+{
+    auto time = stats.duration.count();
+    uint64_t nps = time > 0 ? stats.nodes * 1000 / time : 0;
+
+    std::ostringstream info;
+    info << "info depth " << stats.depth;
+    if (stats.pvIndex > 1 || engine.getMultiPv() > 1)
+        info << " multipv " << stats.pvIndex;
+    info << " score " << formatScore(stats.score)
+         << " nodes " << stats.nodes
+         << " nps " << nps
+         << " hashfull " << engine.getHashfull()
+         << " time " << time
+         << " pv";
+    for (const auto &move : stats.pv)
+    {
+        info << " " << chess::uci::moveToUci(move);
+    }
+    send(info.str());
+}
+
+std::string Uci::formatScore(int score)
+{
+    // Mate scores are CHECKMATE_SCORE minus the distance in plies
+    int matePlies = ChessEngine::CHECKMATE_SCORE - std::abs(score);
+    if (matePlies <= SearchHeuristics::MAX_PLY)
+    {
+        int moves = (matePlies + 1) / 2;
+        return "mate " + std::to_string(score > 0 ? moves : -moves);
+    }
+    return "cp " + std::to_string(score);
+}
+
+void Uci::uci()
+{
+    send("id name Chess Engine");
+    send("id author the Chess Engine developers");
+    send("option name Hash type spin default " + std::to_string(DEFAULT_HASH_MB) +
+         " min 1 max " + std::to_string(MAX_HASH_MB));
+    send("option name Threads type spin default 1 min 1 max " + std::to_string(MAX_THREADS));
+    send("option name MultiPV type spin default 1 min 1 max " + std::to_string(MAX_MULTI_PV));
+    send("option name OwnBook type check default false");
+    send("option name BookFile type string default <empty>");
+    send("option name BookRandom type check default false");
+    send("option name Ponder type check default false");
+    send("uciok");
+}
+
+void Uci::setOption(std::istringstream &args)
+{
+    // setoption name <id> [value <x>], the id may contain spaces
+    std::string token, name, value;
+    args >> token;
+    while (args >> token && token != "value")
+        name += (name.empty() ? "" : " ") + token;
+    while (args >> token)
+        value += (value.empty() ? "" : " ") + token;
+
+    waitForSearch();
+
+    if (name == "Hash")
+        engine.setHashSize(std::clamp(std::atoi(value.c_str()), 1, MAX_HASH_MB));
+    else if (name == "Threads")
+        engine.setThreads(std::clamp(std::atoi(value.c_str()), 1, MAX_THREADS));
+    else if (name == "MultiPV")
+        engine.setMultiPv(std::atoi(value.c_str()));
+    else if (name == "OwnBook")
+    {
+        ownBook = value == "true";
+        updateBook();
+    }
+    else if (name == "BookFile")
+    {
+        bookFile = value == "<empty>" ? "" : value;
+        bookLoaded = false;
+        updateBook();
+    }
+    else if (name == "BookRandom")
+    {
+        engine.setBookSelection(value == "true" ? OpeningMove::Selection::WEIGHTED_RANDOM
+                                                : OpeningMove::Selection::BEST_WEIGHT);
+        bookLoaded = false;
+        updateBook();
+    }
+    else if (name != "Ponder")
+        send("info string unknown option: " + name);
+}
+
+void Uci::updateBook()
+{
+    // The book is only read once it is enabled, and again after its settings change
+    if (ownBook && !bookLoaded)
+    {
+        bookLoaded = bookFile.empty() ? engine.initializeOpeningBook() : engine.loadOpeningBook(bookFile);
+        if (!bookLoaded)
+            send("info string cannot load opening book " + (bookFile.empty() ? std::string("assets/opening") : bookFile));
+    }
+    engine.enableOpeningBook(ownBook && bookLoaded);
+}
+
+void Uci::position(std::istringstream &args)
+{
+    waitForSearch();
+
+    std::string token;
+    args >> token;
+    if (token == "startpos")
+    {
+        board = chess::Board();
+        args >> token; // "moves"
+    }
+    else if (token == "fen")
+    {
+        std::string fen;
+        while (args >> token && token != "moves")
+            fen += (fen.empty() ? "" : " ") + token;
+        board = chess::Board(fen);
+    }
+    else
+    {
+        return;
+    }
+
+    while (args >> token)
+    {
+        chess::Move move = chess::uci::uciToMove(board, token);
+        chess::Movelist legal;
+        chess::movegen::legalmoves(legal, board);
+        if (legal.find(move) < 0)
+        {
+            send("info string illegal move: " + token);
+            return;
+        }
+        board.makeMove(move);
+    }
+}
+
+void Uci::go(std::istringstream &args)
+{
+    waitForSearch();
+
+    SearchLimits limits;
+    bool infinite = false;
+    std::string token;
+    while (args >> token)
+    {
+        if (token == "wtime")
+            args >> limits.wtime;
+        else if (token == "btime")
+            args >> limits.btime;
+        else if (token == "winc")
+            args >> limits.winc;
+        else if (token == "binc")
+            args >> limits.binc;
+        else if (token == "movestogo")
+            args >> limits.movestogo;
+        else if (token == "movetime")
+            args >> limits.movetime;
+        else if (token == "depth")
+            args >> limits.depth;
+        else if (token == "nodes")
+            args >> limits.nodes;
+        else if (token == "infinite")
+            infinite = true;
+        else if (token == "ponder")
+            limits.ponder = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(holdMutex);
+        holdBestMove = infinite || limits.ponder;
+    }
+    engine.clearStop();
+
+    searchThread = std::thread([this, limits, position = board]() mutable
+                               {
+        chess::Move bestMove = engine.getBestMove(position, limits);
+        std::vector<chess::Move> pv = engine.getLastPv();
+
+        {
+            std::unique_lock<std::mutex> lock(holdMutex);
+            holdCondition.wait(lock, [this]() { return !holdBestMove; });
+        }
+
+        std::string line = "bestmove ";
+        line += bestMove == chess::Move::NULL_MOVE ? "0000" : chess::uci::moveToUci(bestMove);
+        if (pv.size() > 1 && pv[0] == bestMove)
+            line += " ponder " + chess::uci::moveToUci(pv[1]);
+        send(line); });
+}
+
+void Uci::stop()
+{
+    engine.stop();
+    releaseBestMove();
+}
+
+void Uci::ponderHit()
+{
+    engine.ponderHit();
+    releaseBestMove();
+}
+
+void Uci::releaseBestMove()
+{
+    {
+        std::lock_guard<std::mutex> lock(holdMutex);
+        holdBestMove = false;
+    }
+    holdCondition.notify_all();
+}
+
+void Uci::waitForSearch()
+{
+    if (searchThread.joinable())
+    {
+        // Normally the search is over already, an infinite one would never end
+        stop();
+        searchThread.join();
+    }
+}
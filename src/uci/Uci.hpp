@@ -0,0 +1,74 @@
+#ifndef UCI_HPP
+#define UCI_HPP
+
+#include "../chess.hpp"
+#include "../engine/ChessEngine.hpp"
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Universal Chess Interface front end for ChessEngine. Commands are read on
+// the calling thread while the search runs on a worker thread, so stop,
+// ponderhit and isready are answered immediately.
+class Uci
+{
+public:
+    explicit Uci(std::ostream &out);
+    ~Uci();
+
+    // Process commands from in until quit or end of input
+    void loop(std::istream &in);
+
+    // Fixed-depth search of the built-in bench positions: "bench [hash] [threads] [depth]".
+    // With one thread the total node count is deterministic and works as a
+    // signature of the search, any change to the searched tree changes it.
+    void bench(std::istringstream &args);
+
+private:
+    static constexpr int DEFAULT_HASH_MB = 64;
+    static constexpr int MAX_HASH_MB = 4096;
+    static constexpr int MAX_THREADS = 256;
+    static constexpr int MAX_MULTI_PV = 256;
+    static constexpr int BENCH_HASH_MB = 16;
+    static constexpr int BENCH_DEPTH = 7;
+
+    std::ostream &out;
+    std::mutex outMutex; // info lines come from the search thread
+
+    ChessEngine engine{false};
+    chess::Board board;
+    bool ownBook = false;
+    std::string bookFile; // empty for the built-in book
+    bool bookLoaded = false;
+
+    std::thread searchThread;
+    // go infinite and go ponder must not send bestmove before stop or ponderhit
+    std::mutex holdMutex;
+    std::condition_variable holdCondition;
+    bool holdBestMove = false; // guarded by holdMutex
+
+    void send(const std::string &line);
+    void sendInfo(const ChessEngine::SearchStats &stats);
+
+    void uci();
+    void setOption(std::istringstream &args);
+    void updateBook();
+    void position(std::istringstream &args);
+    void go(std::istringstream &args);
+    void stop();
+    void ponderHit();
+
+    // Stop the search if one is running and wait for its thread, the
+    // engine may only be reconfigured in between searches
+    void waitForSearch();
+
+    void releaseBestMove();
+
+    // "cp 35" or "mate -3"
+    static std::string formatScore(int score);
+};
+
+#endif // UCI_HPP
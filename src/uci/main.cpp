@@ -0,0 +1,38 @@
+// UCI executable: plug the engine into any UCI GUI or match runner
+//
+// Usage: chess_engine
+//        chess_engine bench [hash] [threads] [depth]
+
+#include "Uci.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+
+int main(int argc, char **argv)
+{
+    // stdout carries the protocol only, engine diagnostics go to stderr
+    std::ostream protocol(std::cout.rdbuf());
+    std::streambuf *stdoutBuffer = std::cout.rdbuf(std::cerr.rdbuf());
+
+    {
+        Uci uci(protocol);
+        if (argc > 1 && std::string(argv[1]) == "bench")
+        {
+            // Command line bench for scripts, the arguments are those of the bench command
+            std::string command = "bench";
+            for (int i = 2; i < argc; i++)
+            {
+                command += std::string(" ") + argv[i];
+            }
+            std::istringstream input(command);
+            uci.loop(input);
+        }
+        else
+        {
+            uci.loop(std::cin);
+        }
+    }
+
+    std::cout.rdbuf(stdoutBuffer);
+    return 0;
+}
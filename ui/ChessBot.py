@@ -11,8 +11,13 @@ sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
 from ui.ChessEngineBridge import ChessEngineBridge
 
 class ChessBot:
+    # Background search limits, the same defaults get_best_move uses
+    THINK_TIME_MS = 10000
+    MAX_DEPTH = 7
+
     def __init__(self):
         self.engine = None
+        self.thinking = False
         try:
             # Use the bridge instead of direct pybind11 bindings
             self.engine = ChessEngineBridge()
@@ -49,6 +54,57 @@ class ChessBot:
             legal_moves = list(board.legal_moves)
             return random.choice(legal_moves) if legal_moves else None
     
+    def start_move(self, board):
+        """Start searching for a move in the background, the UI keeps running meanwhile"""
+        if not self.engine:
+            return
+        try:
+            self.engine.set_position(board.fen())
+            self.thinking = self.engine.start_search(movetime=self.THINK_TIME_MS, depth=self.MAX_DEPTH)
+        except Exception as e:
+            print(f"Error starting engine search: {e}")
+            self.thinking = False
+
+    def is_thinking(self):
+        """True while the background search started by start_move is running"""
+        if not self.thinking:
+            return False
+        try:
+            return self.engine.poll_search_info()['searching']
+        except Exception as e:
+            print(f"Error polling engine search: {e}")
+            return False
+
+    def search_info(self):
+        """Depth, score, nodes and PV of the background search, None without one"""
+        if not self.thinking:
+            return None
+        return self.engine.poll_search_info()
+
+    def finish_move(self, board):
+        """Collect the move of the background search, falling back to a random move"""
+        best_move = None
+        if self.thinking:
+            try:
+                best_move = self.engine.wait_best_move()
+            except Exception as e:
+                print(f"Error getting move from engine: {e}")
+            self.thinking = False
+        if best_move and best_move in board.legal_moves:
+            return best_move
+
+        if not self.engine:
+            print("Warning: Using fallback random move selection (engine not available)")
+        legal_moves = list(board.legal_moves)
+        return random.choice(legal_moves) if legal_moves else None
+
+    def cancel(self):
+        """Abandon the background search and wait for the engine thread to finish"""
+        if self.thinking:
+            self.engine.stop_search()
+            self.engine.wait_best_move()
+            self.thinking = False
+
     def evaluate(self, board):
         # Use our engine's evaluation function
         if not self.engine:
@@ -9,9 +9,12 @@ from ctypes import wintypes
 class ChessEngineBridge:
     """
     Bridge class to connect Python with the C++ ChessEngineWrapper
-    using ctypes instead of pybind11
+    using ctypes instead of pybind11. Every bridge owns a separate engine
+    instance, so several games can be played or analysed side by side.
     """
-    def __init__(self):
+    def __init__(self, hash_mb=0, threads=1, share_book_with=None):
+        """hash_mb <= 0 keeps the default hash size, share_book_with is another
+        ChessEngineBridge whose opening book is reused instead of loaded again"""
         # Determine the correct library extension based on platform
         if platform.system() == "Windows":
             lib_ext = ".dll"
@@ -89,65 +92,121 @@ class ChessEngineBridge:
             
         # Define function signatures
         
-        # void create_engine()
-        self.lib.create_engine.argtypes = []
-        self.lib.create_engine.restype = None
+        # ChessEngineWrapper* engine_new(int hash_mb, int threads, ChessEngineWrapper* book_source)
+        self.lib.engine_new.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_void_p]
+        self.lib.engine_new.restype = ctypes.c_void_p
         
-        # void destroy_engine()
-        self.lib.destroy_engine.argtypes = []
-        self.lib.destroy_engine.restype = None
+        # void engine_free(ChessEngineWrapper* handle)
+        self.lib.engine_free.argtypes = [ctypes.c_void_p]
+        self.lib.engine_free.restype = None
         
-        # void set_position(const char* fen)
-        self.lib.set_position.argtypes = [ctypes.c_char_p]
-        self.lib.set_position.restype = None
+        # void engine_set_hash_size(ChessEngineWrapper* handle, int hash_mb)
+        self.lib.engine_set_hash_size.argtypes = [ctypes.c_void_p, ctypes.c_int]
+        self.lib.engine_set_hash_size.restype = None
         
-        # void get_best_move(char* result, int max_length)
-        self.lib.get_best_move.argtypes = [ctypes.c_char_p, ctypes.c_int]
-        self.lib.get_best_move.restype = None
+        # int engine_load_opening_book(ChessEngineWrapper* handle, const char* path, int random)
+        self.lib.engine_load_opening_book.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int]
+        self.lib.engine_load_opening_book.restype = ctypes.c_int
         
-        # bool make_move(const char* move)
-        self.lib.make_move.argtypes = [ctypes.c_char_p]
-        self.lib.make_move.restype = ctypes.c_bool
+        # void engine_set_position(ChessEngineWrapper* handle, const char* fen)
+        self.lib.engine_set_position.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+        self.lib.engine_set_position.restype = None
         
-        # void get_fen(char* result, int max_length)
-        self.lib.get_fen.argtypes = [ctypes.c_char_p, ctypes.c_int]
-        self.lib.get_fen.restype = None
+        # void engine_get_best_move(ChessEngineWrapper* handle, char* result, int max_length)
+        self.lib.engine_get_best_move.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int]
+        self.lib.engine_get_best_move.restype = None
         
-        # bool is_game_over()
-        self.lib.is_game_over.argtypes = []
-        self.lib.is_game_over.restype = ctypes.c_bool
+        # void engine_get_best_move_with_limits(ChessEngineWrapper* handle, char* result, int max_length,
+        #                                       int wtime, int btime, int winc, int binc, int movestogo,
+        #                                       int movetime, int depth, long long nodes)
+        self.lib.engine_get_best_move_with_limits.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int,
+                                                              ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int,
+                                                              ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_longlong]
+        self.lib.engine_get_best_move_with_limits.restype = None
         
-        # void reset_board()
-        self.lib.reset_board.argtypes = []
-        self.lib.reset_board.restype = None
+        # bool engine_start_search(ChessEngineWrapper* handle, int wtime, int btime, int winc, int binc,
+        #                          int movestogo, int movetime, int depth, long long nodes)
+        self.lib.engine_start_search.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int,
+                                                 ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_longlong]
+        self.lib.engine_start_search.restype = ctypes.c_bool
         
-        # bool is_move_legal(const char* move)
-        self.lib.is_move_legal.argtypes = [ctypes.c_char_p]
-        self.lib.is_move_legal.restype = ctypes.c_bool
+        # bool engine_poll_search_info(ChessEngineWrapper* handle, int* depth, int* score, long long* nodes,
+        #                              int* time_ms, char* pv, int pv_length)
+        self.lib.engine_poll_search_info.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_int), ctypes.POINTER(ctypes.c_int),
+                                                     ctypes.POINTER(ctypes.c_longlong), ctypes.POINTER(ctypes.c_int),
+                                                     ctypes.c_char_p, ctypes.c_int]
+        self.lib.engine_poll_search_info.restype = ctypes.c_bool
         
-        # bool is_in_check()
-        self.lib.is_in_check.argtypes = []
-        self.lib.is_in_check.restype = ctypes.c_bool
+        # void engine_wait_best_move(ChessEngineWrapper* handle, char* result, int max_length)
+        self.lib.engine_wait_best_move.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int]
+        self.lib.engine_wait_best_move.restype = None
         
-        # bool get_side_to_move()
-        self.lib.get_side_to_move.argtypes = []
-        self.lib.get_side_to_move.restype = ctypes.c_bool
+        # void engine_stop_search(ChessEngineWrapper* handle)
+        self.lib.engine_stop_search.argtypes = [ctypes.c_void_p]
+        self.lib.engine_stop_search.restype = None
         
-        # int get_evaluation()
-        self.lib.get_evaluation.argtypes = []
-        self.lib.get_evaluation.restype = ctypes.c_int
+        # void engine_get_pv(ChessEngineWrapper* handle, char* result, int max_length)
+        self.lib.engine_get_pv.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int]
+        self.lib.engine_get_pv.restype = None
         
-        # Initialize the engine
-        self.lib.create_engine()
+        # void engine_set_threads(ChessEngineWrapper* handle, int threads)
+        self.lib.engine_set_threads.argtypes = [ctypes.c_void_p, ctypes.c_int]
+        self.lib.engine_set_threads.restype = None
+        
+        # bool engine_make_move(ChessEngineWrapper* handle, const char* move)
+        self.lib.engine_make_move.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+        self.lib.engine_make_move.restype = ctypes.c_bool
+        
+        # void engine_get_fen(ChessEngineWrapper* handle, char* result, int max_length)
+        self.lib.engine_get_fen.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int]
+        self.lib.engine_get_fen.restype = None
+        
+        # bool engine_is_game_over(ChessEngineWrapper* handle)
+        self.lib.engine_is_game_over.argtypes = [ctypes.c_void_p]
+        self.lib.engine_is_game_over.restype = ctypes.c_bool
+        
+        # void engine_reset_board(ChessEngineWrapper* handle)
+        self.lib.engine_reset_board.argtypes = [ctypes.c_void_p]
+        self.lib.engine_reset_board.restype = None
+        
+        # bool engine_is_move_legal(ChessEngineWrapper* handle, const char* move)
+        self.lib.engine_is_move_legal.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+        self.lib.engine_is_move_legal.restype = ctypes.c_bool
+        
+        # bool engine_is_in_check(ChessEngineWrapper* handle)
+        self.lib.engine_is_in_check.argtypes = [ctypes.c_void_p]
+        self.lib.engine_is_in_check.restype = ctypes.c_bool
+        
+        # bool engine_get_side_to_move(ChessEngineWrapper* handle)
+        self.lib.engine_get_side_to_move.argtypes = [ctypes.c_void_p]
+        self.lib.engine_get_side_to_move.restype = ctypes.c_bool
+        
+        # int engine_get_evaluation(ChessEngineWrapper* handle)
+        self.lib.engine_get_evaluation.argtypes = [ctypes.c_void_p]
+        self.lib.engine_get_evaluation.restype = ctypes.c_int
+        
+        # Create this bridge's own engine instance
+        self.handle = self.lib.engine_new(int(hash_mb), int(threads),
+                                          share_book_with.handle if share_book_with else None)
         
     def __del__(self):
         """Clean up when the object is deleted"""
-        if hasattr(self, 'lib'):
-            self.lib.destroy_engine()
+        if getattr(self, 'handle', None):
+            self.lib.engine_free(self.handle)
+            self.handle = None
+    
+    def set_hash_size(self, hash_mb):
+        """Resize the transposition table, clearing it"""
+        self.lib.engine_set_hash_size(self.handle, int(hash_mb))
+    
+    def load_opening_book(self, path, random=False):
+        """Use a PGN file or a Polyglot .bin book, with random=True moves are
+        picked in proportion to their weight. Returns False if it cannot be read"""
+        return bool(self.lib.engine_load_opening_book(self.handle, path.encode('utf-8'), int(random)))
     
     def set_position(self, fen):
         """Set the board position using FEN notation"""
-        self.lib.set_position(fen.encode('utf-8'))
+        self.lib.engine_set_position(self.handle, fen.encode('utf-8'))
     
     def get_best_move(self):
         """Get the best move for the current position as a python-chess Move object"""
@@ -156,7 +215,7 @@ class ChessEngineBridge:
         result_buffer = ctypes.create_string_buffer(buffer_size)
         
         # Call the C function
-        self.lib.get_best_move(result_buffer, buffer_size)
+        self.lib.engine_get_best_move(self.handle, result_buffer, buffer_size)
         
         # Convert the result to a string and then to a python-chess Move
         uci_move = result_buffer.value.decode('utf-8')
@@ -169,6 +228,89 @@ class ChessEngineBridge:
         except ValueError:
             return None
     
+    def get_best_move_with_limits(self, wtime=0, btime=0, winc=0, binc=0,
+                                  movestogo=0, movetime=0, depth=0, nodes=0):
+        """Get the best move within clock and search limits (milliseconds, 0 = unset).
+        With no clock for the side to move, movetime, depth or nodes the default
+        move time and depth of get_best_move are used"""
+        buffer_size = 10
+        result_buffer = ctypes.create_string_buffer(buffer_size)
+        
+        self.lib.engine_get_best_move_with_limits(self.handle, result_buffer, buffer_size,
+                                           int(wtime), int(btime), int(winc), int(binc),
+                                           int(movestogo), int(movetime), int(depth), int(nodes))
+        
+        uci_move = result_buffer.value.decode('utf-8')
+        
+        if not uci_move:
+            return None
+            
+        try:
+            return chess.Move.from_uci(uci_move)
+        except ValueError:
+            return None
+    
+    def start_search(self, wtime=0, btime=0, winc=0, binc=0,
+                     movestogo=0, movetime=0, depth=0, nodes=0):
+        """Start searching the current position in the background, returns False if there is no legal move.
+        With no limit set it runs until stop_search. A search still running is stopped first"""
+        return self.lib.engine_start_search(self.handle, int(wtime), int(btime), int(winc), int(binc),
+                                     int(movestogo), int(movetime), int(depth), int(nodes))
+    
+    def poll_search_info(self):
+        """Get the progress of the background search without waiting for it.
+        Returns a dict with depth, score, nodes, time_ms, pv (list of UCI strings) and searching"""
+        depth = ctypes.c_int(0)
+        score = ctypes.c_int(0)
+        nodes = ctypes.c_longlong(0)
+        time_ms = ctypes.c_int(0)
+        buffer_size = 1024
+        pv_buffer = ctypes.create_string_buffer(buffer_size)
+        
+        searching = self.lib.engine_poll_search_info(self.handle, ctypes.byref(depth), ctypes.byref(score), ctypes.byref(nodes),
+                                              ctypes.byref(time_ms), pv_buffer, buffer_size)
+        return {
+            'depth': depth.value,
+            'score': score.value,
+            'nodes': nodes.value,
+            'time_ms': time_ms.value,
+            'pv': pv_buffer.value.decode('utf-8').split(),
+            'searching': searching,
+        }
+    
+    def wait_best_move(self):
+        """Wait for the background search to finish and get its move as a python-chess Move object"""
+        buffer_size = 10
+        result_buffer = ctypes.create_string_buffer(buffer_size)
+        
+        self.lib.engine_wait_best_move(self.handle, result_buffer, buffer_size)
+        
+        uci_move = result_buffer.value.decode('utf-8')
+        
+        if not uci_move:
+            return None
+            
+        try:
+            return chess.Move.from_uci(uci_move)
+        except ValueError:
+            return None
+    
+    def stop_search(self):
+        """Stop a search running on another thread, it returns its best move so far"""
+        self.lib.engine_stop_search(self.handle)
+    
+    def get_pv(self):
+        """Get the principal variation of the last search as a list of UCI strings"""
+        buffer_size = 1024  # up to MAX_PLY moves of 5 chars each
+        result_buffer = ctypes.create_string_buffer(buffer_size)
+        
+        self.lib.engine_get_pv(self.handle, result_buffer, buffer_size)
+        return result_buffer.value.decode('utf-8').split()
+    
+    def set_threads(self, threads):
+        """Set the number of search threads used by the engine"""
+        self.lib.engine_set_threads(self.handle, int(threads))
+    
     def make_move(self, move):
         """Make a move on the board (takes python-chess Move object)"""
         if isinstance(move, chess.Move):
@@ -176,23 +318,23 @@ class ChessEngineBridge:
         else:
             move_str = str(move)
             
-        return self.lib.make_move(move_str.encode('utf-8'))
+        return self.lib.engine_make_move(self.handle, move_str.encode('utf-8'))
     
     def get_fen(self):
         """Get the current position in FEN notation"""
         buffer_size = 100  # FEN strings can be long
         result_buffer = ctypes.create_string_buffer(buffer_size)
         
-        self.lib.get_fen(result_buffer, buffer_size)
+        self.lib.engine_get_fen(self.handle, result_buffer, buffer_size)
         return result_buffer.value.decode('utf-8')
     
     def is_game_over(self):
         """Check if the game is over"""
-        return self.lib.is_game_over()
+        return self.lib.engine_is_game_over(self.handle)
     
     def reset_board(self):
         """Reset the board to the starting position"""
-        self.lib.reset_board()
+        self.lib.engine_reset_board(self.handle)
     
     def is_move_legal(self, move):
         """Check if a move is legal (takes python-chess Move object)"""
@@ -201,16 +343,16 @@ class ChessEngineBridge:
         else:
             move_str = str(move)
             
-        return self.lib.is_move_legal(move_str.encode('utf-8'))
+        return self.lib.engine_is_move_legal(self.handle, move_str.encode('utf-8'))
     
     def is_in_check(self):
         """Check if the current player is in check"""
-        return self.lib.is_in_check()
+        return self.lib.engine_is_in_check(self.handle)
     
     def get_side_to_move(self):
         """Get the side to move (True for white, False for black)"""
-        return self.lib.get_side_to_move()
+        return self.lib.engine_get_side_to_move(self.handle)
         
     def get_evaluation(self):
         """Get the evaluation of the current position"""
-        return self.lib.get_evaluation()
\ No newline at end of file
+        return self.lib.engine_get_evaluation(self.handle)
\ No newline at end of file
@@ -93,7 +93,7 @@ class ChessGame:
         bot = self.white_bot if self.board.turn == chess.WHITE else self.black_bot
 
         if bot:
-            move = bot.choose_move(self.board)
+            move = bot.finish_move(self.board)
             if move:
                 # Check if this is a capture before making the move
                 is_capture = self.board.piece_at(move.to_square) is not None
@@ -149,13 +149,24 @@ class ChessGame:
         current_time = time.time()
 
         if not self.is_human_turn():
+            bot = self.white_bot if self.board.turn == chess.WHITE else self.black_bot
             if not self.waiting_for_bot:
+                # The engine searches on its own thread, the pygame loop keeps running
                 self.waiting_for_bot = True
                 self.last_bot_move_time = current_time
-            elif current_time - self.last_bot_move_time >= self.bot_move_time:
+                if bot:
+                    bot.start_move(self.board)
+            elif current_time - self.last_bot_move_time >= self.bot_move_time and \
+                    not (bot and bot.is_thinking()):
                 self.make_bot_move()
                 self.waiting_for_bot = False
 
+    def shutdown(self):
+        """Stop any bot that is still thinking, call before the window closes"""
+        for bot in (self.white_bot, self.black_bot):
+            if bot:
+                bot.cancel()
+
     def get_game_state(self):
         if self.game_over:
             if self.board.is_checkmate():
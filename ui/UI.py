@@ -267,6 +267,7 @@ class UI:
             pos = pygame.mouse.get_pos()
 
             if self.restart_button.collidepoint(pos):
+                self.game.shutdown()
                 self.show_mode_selection = True
                 return
 
@@ -329,5 +330,7 @@ class UI:
 
             clock.tick(60)
 
+        if self.game:
+            self.game.shutdown()
         pygame.quit()
 